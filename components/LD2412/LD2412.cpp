@@ -1,5 +1,6 @@
 #include "LD2412.h"
 
+#include <algorithm>
 #include <utility>
 #ifdef USE_NUMBER
 #include "esphome/components/number/number.h"
@@ -7,6 +8,16 @@
 #ifdef USE_SENSOR
 #include "esphome/components/sensor/sensor.h"
 #endif
+#ifdef USE_LD2412_LOW_POWER
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
+#ifdef USE_ESP_IDF
+#include "esphome/components/uart/uart_component_esp_idf.h"
+#else
+#include "esphome/components/uart/uart_component_esp32_arduino.h"
+#endif
+#endif
 
 #define highbyte(val) (uint8_t)((val) >> 8)
 #define lowbyte(val) (uint8_t)((val) &0xff)
@@ -20,11 +31,23 @@ LD2412Component::LD2412Component() {}
 
 void LD2412Component::dump_config() {
   ESP_LOGCONFIG(TAG, "LD2412:");
+  ESP_LOGCONFIG(TAG, "  Instance size: %u bytes", static_cast<unsigned>(sizeof(LD2412Component)));
 #ifdef USE_BINARY_SENSOR
   LOG_BINARY_SENSOR("  ", "TargetBinarySensor", this->target_binary_sensor_);
   LOG_BINARY_SENSOR("  ", "MovingTargetBinarySensor", this->moving_target_binary_sensor_);
   LOG_BINARY_SENSOR("  ", "StillTargetBinarySensor", this->still_target_binary_sensor_);
   LOG_BINARY_SENSOR("  ", "OutPinPresenceStatusBinarySensor", this->out_pin_presence_status_binary_sensor_);
+#ifdef USE_LD2412_INTERFERENCE
+  LOG_BINARY_SENSOR("  ", "InterferenceBinarySensor", this->interference_binary_sensor_);
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  LOG_BINARY_SENSOR("  ", "OnlineBinarySensor", this->online_binary_sensor_);
+#endif
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  for (binary_sensor::BinarySensor *s : this->zone_binary_sensors_) {
+    LOG_BINARY_SENSOR("  ", "ZoneBinarySensor", s);
+  }
+#endif
 #endif
 #ifdef USE_SWITCH
 //  LOG_SWITCH("  ", "EngineeringModeSwitch", this->engineering_mode_switch_);
@@ -42,6 +65,37 @@ void LD2412Component::dump_config() {
   LOG_SENSOR("  ", "MovingTargetEnergySensor", this->moving_target_energy_sensor_);
   LOG_SENSOR("  ", "StillTargetEnergySensor", this->still_target_energy_sensor_);
   LOG_SENSOR("  ", "DetectionDistanceSensor", this->detection_distance_sensor_);
+#ifdef USE_LD2412_LOOP_STATS
+  LOG_SENSOR("  ", "LoopRateSensor", this->loop_rate_sensor_);
+  LOG_SENSOR("  ", "ParserTimeSensor", this->parser_time_sensor_);
+  LOG_SENSOR("  ", "DroppedFramesSensor", this->dropped_frames_sensor_);
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  LOG_SENSOR("  ", "FrameJitterSensor", this->frame_jitter_sensor_);
+  LOG_SENSOR("  ", "FrameIntervalSensor", this->frame_interval_sensor_);
+  LOG_SENSOR("  ", "FrameIntervalMinSensor", this->frame_interval_min_sensor_);
+  LOG_SENSOR("  ", "FrameIntervalMaxSensor", this->frame_interval_max_sensor_);
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  LOG_SENSOR("  ", "SpikeRateSensor", this->spike_rate_sensor_);
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  LOG_SENSOR("  ", "RecoveryAttemptsSensor", this->recovery_attempts_sensor_);
+  LOG_SENSOR("  ", "RecoveriesSensor", this->recoveries_sensor_);
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  LOG_SENSOR("  ", "DeferredPublishesSensor", this->deferred_publishes_sensor_);
+  LOG_SENSOR("  ", "CoalescedPublishesSensor", this->coalesced_publishes_sensor_);
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  LOG_SENSOR("  ", "BackgroundCorrectionProgressSensor", this->background_correction_progress_sensor_);
+  LOG_SENSOR("  ", "BackgroundCorrectionRemainingSensor", this->background_correction_remaining_sensor_);
+#endif
+#ifdef USE_LD2412_ZONE_ENERGY
+  for (sensor::Sensor *s : this->zone_energy_sensors_) {
+    LOG_SENSOR("  ", "ZoneEnergySensor", s);
+  }
+#endif
   //for (sensor::Sensor *s : this->gate_still_sensors_) {
   //  LOG_SENSOR("  ", "NthGateStillSesnsor", s);
   //}
@@ -52,16 +106,18 @@ void LD2412Component::dump_config() {
 #ifdef USE_TEXT_SENSOR
   LOG_TEXT_SENSOR("  ", "VersionTextSensor", this->version_text_sensor_);
   LOG_TEXT_SENSOR("  ", "MacTextSensor", this->mac_text_sensor_);
+  LOG_TEXT_SENSOR("  ", "GateRangesTextSensor", this->gate_ranges_text_sensor_);
+  LOG_TEXT_SENSOR("  ", "GateEnergiesTextSensor", this->gate_energies_text_sensor_);
 #endif
 #ifdef USE_SELECT
-//  LOG_SELECT("  ", "LightFunctionSelect", this->light_function_select_);
+  LOG_SELECT("  ", "LightFunctionSelect", this->light_function_select_);
   LOG_SELECT("  ", "OutPinLevelSelect", this->out_pin_level_select_);
   //LOG_SELECT("  ", "DistanceResolutionSelect", this->distance_resolution_select_);
   LOG_SELECT("  ", "BaudRateSelect", this->baud_rate_select_);
   LOG_SELECT("  ", "ModeSelect", this->mode_select_);
 #endif
 #ifdef USE_NUMBER
-//  LOG_NUMBER("  ", "LightThresholdNumber", this->light_threshold_number_);
+  LOG_NUMBER("  ", "LightThresholdNumber", this->light_threshold_number_);
   LOG_NUMBER("  ", "MaxDistanceGateNumber", this->max_distance_gate_number_);
   LOG_NUMBER("  ", "MinDistanceGateNumber", this->min_distance_gate_number_);
   LOG_NUMBER("  ", "TimeoutNumber", this->timeout_number_);
@@ -74,13 +130,168 @@ void LD2412Component::dump_config() {
 #endif
   this->read_all_info();
   ESP_LOGCONFIG(TAG, "  Throttle_ : %ums", this->throttle_);
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  ESP_LOGCONFIG(TAG, "  Publish budget : %u per loop, %u per second", this->publish_scheduler_.get_loop_budget(),
+                this->publish_scheduler_.get_second_budget());
+#endif
+  ESP_LOGCONFIG(TAG, "  RX mode : %s",
+                this->rx_mode_ == RX_MODE_TASK              ? "task"
+                : this->rx_mode_ == RX_MODE_FRAME_THRESHOLD ? "frame_threshold"
+                                                            : "polling");
+#ifdef USE_LD2412_LOOP_STATS
+  ESP_LOGCONFIG(TAG, "  Dropped frames : %u", (unsigned) this->dropped_frames_);
+#endif
+#ifdef USE_LD2412_HISTORY
+  ESP_LOGCONFIG(TAG, "  History : %u frames, %u bytes", (unsigned) this->history_.capacity(),
+                (unsigned) (this->history_.capacity() * sizeof(FrameRecord)));
+#endif
+#ifdef USE_LD2412_STREAM
+  if (this->streamer_.is_configured())
+    this->streamer_.dump_config();
+#endif
+#ifdef USE_LD2412_TRACE
+  ESP_LOGCONFIG(TAG, "  Trace : %u events, %u bytes", (unsigned) this->trace_.capacity(),
+                (unsigned) (this->trace_.capacity() * sizeof(TraceEvent)));
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  ESP_LOGCONFIG(TAG, "  Command statistics : %u ACKs, mean %.1fms, max %.1fms", (unsigned) this->command_stats_.count(),
+                this->command_stats_.mean() / 1000, this->command_stats_.max() / 1000.0f);
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  if (this->low_power_) {
+    ESP_LOGCONFIG(TAG, "  Low power : guard %uus, max sleep %ums, engineering mode off after %us stable",
+                  (unsigned) this->sleep_planner_.get_guard(), (unsigned) (this->sleep_planner_.get_max_sleep() / 1000),
+                  (unsigned) (this->low_power_stable_time_ / 1000));
+    LOG_PIN("  Wake Pin: ", this->wake_pin_);
+  }
+#endif
+#ifdef USE_LD2412_STATS
+  if (this->stats_key_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Statistics : checkpoint every %us in %u slots, gate activity from %u%%, checkpoint %u",
+                  (unsigned) (this->stats_checkpoint_interval_ / 1000), STATS_SLOTS, this->stats_activity_threshold_,
+                  (unsigned) this->stats_.data().sequence);
+  }
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  ESP_LOGCONFIG(TAG, "  Interference threshold : %.2f/s", this->interference_.get_threshold());
+#endif
+  ESP_LOGCONFIG(TAG, "  Gate size : %ucm", this->gate_size_);
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  ESP_LOGCONFIG(TAG, "  Background correction duration : %us",
+                this->background_correction_.get_expected_duration() / 1000);
+#endif
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+  ESP_LOGCONFIG(TAG, "  Distance calibration table : %u entries", (unsigned) this->distance_calibration_.table_size());
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  if (this->watchdog_timeout_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Watchdog timeout : %ums", this->watchdog_timeout_);
+    LOG_PIN("  Power Pin: ", this->power_pin_);
+    ESP_LOGCONFIG(TAG, "  Watchdog config exits : %u, restarts : %u, power cycles : %u, recoveries : %u",
+                  this->watchdog_attempts_[WATCHDOG_EXIT_CONFIG], this->watchdog_attempts_[WATCHDOG_RESTART],
+                  this->watchdog_attempts_[WATCHDOG_POWER_CYCLE], this->watchdog_recoveries_);
+  }
+#endif
   ESP_LOGCONFIG(TAG, "  MAC Address : %s", const_cast<char *>(this->mac_.c_str()));
   ESP_LOGCONFIG(TAG, "  Firmware Version : %s", const_cast<char *>(this->version_.c_str()));
+#ifdef USE_LD2412_CAPABILITIES
+  ESP_LOGCONFIG(TAG, "  Firmware gates : %u%s, light control : %s, background query : %s", this->capabilities_.gates,
+                this->capabilities_.out_pin_in_frame ? " + OUT pin" : "", YESNO(this->capabilities_.light_control),
+                YESNO(this->capabilities_.background_query));
+#endif
 }
 
 void LD2412Component::setup() {
   ESP_LOGCONFIG(TAG, "Setting up LD2412...");
+#ifdef LD2412_FRAME_TIMESTAMPS
+  // 10 bits per byte: start, 8 data, stop
+  this->rx_byte_micros_ = 10000000 / this->parent_->get_baud_rate();
+#endif
+#ifdef USE_LD2412_HISTORY
+  this->history_.init(this->history_size_);
+#endif
+#ifdef USE_LD2412_STREAM
+  if (this->streamer_.is_configured()) {
+    this->streamer_.setup();
+    this->set_interval(this->streamer_.get_flush_interval(), [this]() { this->streamer_.flush(); });
+  }
+#endif
+#ifdef USE_LD2412_TRACE
+  this->trace_.init(this->trace_size_);
+#endif
+#ifdef USE_LD2412_STATS
+  // Other radars of the build may keep statistics, this one only with its own preference key
+  if (this->stats_key_ != 0) {
+    this->restore_stats_();
+    this->set_interval(STATS_UPDATE_INTERVAL, [this]() {
+      uint32_t now = millis();
+      this->stats_.advance(now);
+      this->publish_stats_();
+      // Changes are coalesced until the interval has passed since the last write
+      if (now - this->stats_checkpoint_millis_ >= this->stats_checkpoint_interval_)
+        this->checkpoint_stats_();
+    });
+  }
+#endif
+#ifdef USE_SENSOR
+  // Diagnostics of the features built in, published once a second if any has a sensor
+  bool diagnostics = false;
+#ifdef USE_LD2412_LOOP_STATS
+  diagnostics |= this->loop_rate_sensor_ != nullptr || this->parser_time_sensor_ != nullptr ||
+                 this->dropped_frames_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  diagnostics |= this->frame_jitter_sensor_ != nullptr || this->frame_interval_sensor_ != nullptr ||
+                 this->frame_interval_min_sensor_ != nullptr || this->frame_interval_max_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  diagnostics |= this->spike_rate_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  diagnostics |= this->deferred_publishes_sensor_ != nullptr || this->coalesced_publishes_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  diagnostics |= this->background_correction_progress_sensor_ != nullptr ||
+                 this->background_correction_remaining_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  diagnostics |= this->wakeups_sensor_ != nullptr || this->awake_time_sensor_ != nullptr;
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  diagnostics |= this->command_latency_sensor_ != nullptr || this->command_latency_max_sensor_ != nullptr;
+#endif
+  if (diagnostics)
+    this->set_interval(1000, [this]() { this->publish_loop_stats_(); });
+#endif
+  // Factory default until the module reports its resolution
+  this->apply_distance_resolution_(DISTANCE_RESOLUTION_0_75);
+#ifdef USE_LD2412_WATCHDOG
+  if (this->watchdog_timeout_ != 0) {
+    if (this->power_pin_ != nullptr) {
+      this->power_pin_->setup();
+      this->power_pin_->digital_write(true);
+    }
+    this->watchdog_frame_millis_ = millis();
+    this->set_interval(WATCHDOG_CHECK_INTERVAL, [this]() { this->check_watchdog_(); });
+  }
+#endif
   this->read_all_info();
+#ifdef USE_LD2412_RX_TASK
+  if (this->rx_mode_ == RX_MODE_TASK) {
+    // ACKs of read_all_info are handled by the loop once the task runs
+#if CONFIG_FREERTOS_UNICORE
+    const BaseType_t core = 0;
+#else
+    // Keep away from the WiFi/network stack on core 0
+    const BaseType_t core = 1;
+#endif
+    if (xTaskCreatePinnedToCore(LD2412Component::rx_task_, "ld2412_rx", RX_TASK_STACK_SIZE, this, RX_TASK_PRIORITY,
+                                &this->rx_task_handle_, core) != pdPASS) {
+      ESP_LOGE(TAG, "Could not start the RX task, falling back to polling");
+      this->rx_mode_ = RX_MODE_POLLING;
+    }
+  }
+#endif
   ESP_LOGCONFIG(TAG, "Mac Address : %s", const_cast<char *>(this->mac_.c_str()));
   ESP_LOGCONFIG(TAG, "Firmware Version : %s", const_cast<char *>(this->version_.c_str()));
   ESP_LOGCONFIG(TAG, "LD2412 setup complete.");
@@ -94,11 +305,14 @@ void LD2412Component::read_all_info() {
   delay(10);  // NOLINT
   this->get_distance_resolution_();
   delay(10);  // NOLINT
-  //this->get_light_control_();
+  this->get_light_control_();
+  delay(10);  // NOLINT
   this->query_parameters_();
   delay(10);  // NOLINT
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
   this->query_dymanic_background_correction_();
   delay(10);  // NOLINT
+#endif
 #ifdef USE_NUMBER
   this->get_gate_threshold();
   delay(10);  // NOLINT
@@ -119,16 +333,348 @@ void LD2412Component::restart_and_read_all_info() {
 }
 
 void LD2412Component::loop() {
-  const int max_line_length = 80;
-  static uint8_t buffer[max_line_length];
+#ifdef USE_LD2412_LOOP_STATS
+  this->loop_count_++;
+#endif
+  this->receive_();
+#ifdef USE_LD2412_COMMAND_STATS
+  for (; this->rx_bad_acks_counted_ != this->rx_bad_acks_; this->rx_bad_acks_counted_++)
+    this->count_ack_error_(ACK_BAD_HEADER, COMMAND_UNKNOWN);
+  if (this->command_stats_.has_pending())
+    this->command_stats_.expire(micros());
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  this->update_background_correction_();
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  this->publish_scheduler_.run(millis());
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  if (this->low_power_)
+    this->light_sleep_();
+#endif
+}
 
+void LD2412Component::receive_() {
+#ifdef USE_LD2412_RX_TASK
+  if (this->rx_mode_ == RX_MODE_TASK) {
+#ifdef USE_LD2412_LOOP_STATS
+    uint32_t start = micros();
+#endif
+    for (RawFrame *frame = this->rx_queue_.front(); frame != nullptr; frame = this->rx_queue_.front()) {
+#ifdef LD2412_FRAME_TIMESTAMPS
+      this->frame_timestamp_ = frame->timestamp;
+#endif
+      this->handle_frame_(frame->data, frame->len);
+      this->rx_queue_.pop();
+    }
+#ifdef USE_LD2412_LOOP_STATS
+    this->parser_micros_ += micros() - start;
+#endif
+    return;
+  }
+#endif
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+  if (this->rx_mode_ == RX_MODE_FRAME_THRESHOLD && !this->rx_ready_())
+    return;
+#endif
+#ifdef USE_LD2412_LOOP_STATS
+  uint32_t start = micros();
+#endif
   while (available()) {
-    this->readline_(read(), buffer, max_line_length);
+    int frame_len = this->readline_(read(), this->rx_buffer_, MAX_FRAME_LENGTH);
+    if (frame_len > 0) {
+#ifdef LD2412_FRAME_TIMESTAMPS
+      this->frame_timestamp_ = this->rx_frame_timestamp_;
+#endif
+      this->handle_frame_(this->rx_buffer_, frame_len);
+    }
+  }
+#ifdef USE_LD2412_LOOP_STATS
+  this->parser_micros_ += micros() - start;
+#endif
+}
+
+#ifdef USE_LD2412_RX_TASK
+/*
+  Runs the frame assembly out of the main loop. Only complete frames are queued,
+  the loop does the decoding and publishing.
+*/
+void LD2412Component::rx_task_(void *params) {
+  auto *self = static_cast<LD2412Component *>(params);
+  uint8_t buffer[MAX_FRAME_LENGTH];
+  while (true) {
+    if (!self->available()) {
+      vTaskDelay(RX_TASK_IDLE_TICKS);
+      continue;
+    }
+    while (self->available()) {
+      int frame_len = self->readline_(self->read(), buffer, MAX_FRAME_LENGTH);
+      if (frame_len == 0)
+        continue;
+      RawFrame *frame = self->rx_queue_.producer_slot();
+      if (frame == nullptr) {
+#ifdef USE_LD2412_LOOP_STATS
+        self->dropped_frames_++;
+#endif
+        continue;
+      }
+      frame->len = frame_len;
+#ifdef LD2412_FRAME_TIMESTAMPS
+      frame->timestamp = self->rx_frame_timestamp_;
+#endif
+      memcpy(frame->data, buffer, frame_len);
+      self->rx_queue_.push();
+    }
+  }
+}
+#endif
+
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+bool LD2412Component::rx_ready_() {
+  uint32_t now = millis();
+  if ((int32_t) (now - this->rx_next_check_millis_) < 0)
+    return false;
+  int pending = this->available();
+  if (pending == 0)
+    return false;
+  if (pending >= this->rx_threshold_)
+    return true;
+  // Short frames (ACKs) are parsed once the line stays idle
+  if (pending != this->rx_pending_) {
+    this->rx_pending_ = pending;
+    this->rx_pending_since_millis_ = now;
+    return false;
+  }
+  return now - this->rx_pending_since_millis_ >= RX_IDLE_TIMEOUT;
+}
+
+void LD2412Component::track_frame_interval_(int len) {
+  uint32_t now = millis();
+  uint32_t interval = now - this->last_frame_millis_;
+  this->last_frame_millis_ = now;
+  this->rx_pending_ = 0;
+  this->rx_threshold_ = len;
+  // Intervals over a second are pauses (config mode), not the frame rate
+  if (interval > 1000)
+    return;
+  this->frame_interval_ = this->frame_interval_ == 0 ? interval : (this->frame_interval_ * 7 + interval) / 8;
+  if (this->rx_mode_ == RX_MODE_FRAME_THRESHOLD) {
+    // Wake up a bit early to absorb jitter
+    this->rx_next_check_millis_ = now + this->frame_interval_ * 3 / 4;
+  }
+}
+#endif
+
+#ifdef USE_SENSOR
+void LD2412Component::publish_loop_stats_() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - this->loop_stats_millis_;
+  if (elapsed == 0)
+    return;
+  this->loop_stats_millis_ = now;
+#ifdef USE_LD2412_LOOP_STATS
+  if (this->loop_rate_sensor_ != nullptr)
+    this->publish_(this->loop_rate_sensor_, this->loop_count_ * 1000.0f / elapsed, PUBLISH_DIAGNOSTIC);
+  if (this->parser_time_sensor_ != nullptr)
+    this->publish_(this->parser_time_sensor_, this->parser_micros_ * 1000.0f / elapsed, PUBLISH_DIAGNOSTIC);
+  if (this->dropped_frames_sensor_ != nullptr)
+    this->publish_changed_(this->dropped_frames_sensor_, this->dropped_frames_, PUBLISH_DIAGNOSTIC);
+  this->loop_count_ = 0;
+  this->parser_micros_ = 0;
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  if (this->frame_jitter_sensor_ != nullptr)
+    this->publish_(this->frame_jitter_sensor_, this->frame_timing_.jitter() / 1000, PUBLISH_DIAGNOSTIC);
+  if (this->frame_interval_sensor_ != nullptr)
+    this->publish_(this->frame_interval_sensor_, this->frame_timing_.mean() / 1000, PUBLISH_DIAGNOSTIC);
+  // Extremes of the intervals since the last publish, nothing while no frame comes
+  if (this->frame_timing_.window_max() != 0) {
+    if (this->frame_interval_min_sensor_ != nullptr)
+      this->publish_(this->frame_interval_min_sensor_, this->frame_timing_.window_min() / 1000.0f,
+                     PUBLISH_DIAGNOSTIC);
+    if (this->frame_interval_max_sensor_ != nullptr)
+      this->publish_(this->frame_interval_max_sensor_, this->frame_timing_.window_max() / 1000.0f,
+                     PUBLISH_DIAGNOSTIC);
+  }
+  this->frame_timing_.reset_window();
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  if (this->background_correction_.active())
+    this->publish_background_correction_();
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  if (this->spike_rate_sensor_ != nullptr)
+    this->publish_(this->spike_rate_sensor_, this->interference_.spike_rate(), PUBLISH_DIAGNOSTIC);
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  if (this->wakeups_sensor_ != nullptr)
+    this->publish_(this->wakeups_sensor_, this->sleep_planner_.wakes() * 60000.0f / elapsed, PUBLISH_DIAGNOSTIC);
+  if (this->awake_time_sensor_ != nullptr) {
+    float asleep = std::min(this->sleep_planner_.slept() / 10.0f / elapsed, 100.0f);
+    this->publish_(this->awake_time_sensor_, 100 - asleep, PUBLISH_DIAGNOSTIC);
+  }
+  this->sleep_planner_.reset_window();
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  if (this->command_stats_.count() != 0) {
+    if (this->command_latency_sensor_ != nullptr)
+      this->publish_changed_(this->command_latency_sensor_, this->command_stats_.mean() / 1000, PUBLISH_DIAGNOSTIC);
+    if (this->command_latency_max_sensor_ != nullptr)
+      this->publish_changed_(this->command_latency_max_sensor_, this->command_stats_.max() / 1000.0f,
+                             PUBLISH_DIAGNOSTIC);
+  }
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  if (this->deferred_publishes_sensor_ != nullptr)
+    this->publish_changed_(this->deferred_publishes_sensor_, this->publish_scheduler_.deferred(), PUBLISH_DIAGNOSTIC);
+  if (this->coalesced_publishes_sensor_ != nullptr)
+    this->publish_changed_(this->coalesced_publishes_sensor_, this->publish_scheduler_.coalesced(),
+                           PUBLISH_DIAGNOSTIC);
+#endif
+}
+#endif
+
+#ifdef USE_SENSOR
+#ifdef USE_LD2412_PUBLISH_BUDGET
+static void publish_sensor(void *entity, float value) { static_cast<sensor::Sensor *>(entity)->publish_state(value); }
+#endif
+
+void LD2412Component::publish_(sensor::Sensor *s, float value, PublishPriority priority) {
+  LD2412_TRACE(TRACE_PUBLISH, priority, 0);
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  this->publish_scheduler_.publish(s, value, priority, publish_sensor);
+#else
+  s->publish_state(value);
+#endif
+}
+
+void LD2412Component::publish_changed_(sensor::Sensor *s, float value, PublishPriority priority) {
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  LD2412_TRACE(TRACE_PUBLISH, priority, 0);
+  this->publish_scheduler_.publish_changed(s, value, s->get_state(), priority, publish_sensor);
+#else
+  if (s->get_state() != value && !(std::isnan(value) && std::isnan(s->get_state()))) {
+    LD2412_TRACE(TRACE_PUBLISH, priority, 0);
+    s->publish_state(value);
+  }
+#endif
+}
+#endif
+
+#ifdef USE_BINARY_SENSOR
+#ifdef USE_LD2412_PUBLISH_BUDGET
+static void publish_binary_sensor(void *entity, float value) {
+  static_cast<binary_sensor::BinarySensor *>(entity)->publish_state(value != 0);
+}
+#endif
+
+void LD2412Component::publish_(binary_sensor::BinarySensor *s, bool state, PublishPriority priority) {
+  LD2412_TRACE(TRACE_PUBLISH, priority, 1);
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  this->publish_scheduler_.publish(s, state, priority, publish_binary_sensor);
+#else
+  s->publish_state(state);
+#endif
+}
+#endif
+
+void LD2412Component::handle_frame_(uint8_t *buffer, int len) {
+  if (buffer[0] == DATA_FRAME_HEADER[0]) {
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+    this->track_frame_interval_(len);
+#endif
+    ESP_LOGV(TAG, "Will handle Periodic Data:  %s", format_buffer(buffer, len).c_str());
+    uint8_t data_type = buffer[offsetof(PeriodicFrame, data_type)];
+    LD2412_TRACE_AT(this->frame_timestamp_, TRACE_FRAME_RECEIVED, len, data_type);
+    LD2412_TRACE(TRACE_FRAME_BEGIN, len, data_type);
+#ifdef USE_LD2412_CAPABILITIES
+    if (data_type == 0x01 && len != this->capabilities_.engineering_frame_size)
+      this->check_frame_layout_(len);
+    (this->*handle_periodic_)(buffer, len);
+#else
+    this->handle_periodic_data_(buffer, len);
+#endif
+    LD2412_TRACE(TRACE_FRAME_END, len, data_type);
+  } else {
+    ESP_LOGV(TAG, "Will handle ACK Data");
+    this->handle_ack_data_(buffer, len);
+  }
+}
+
+#ifdef USE_LD2412_CAPABILITIES
+void LD2412Component::check_frame_layout_(int len) {
+  uint8_t gates;
+  bool out_pin;
+  if (!Capabilities::layout_from_size(len, gates, out_pin) || gates == 0) {
+    ESP_LOGW(TAG, "Engineering frame of %d bytes does not match any known layout, ignoring its gates", len);
+    return;
+  }
+  ESP_LOGW(TAG, "Engineering frames have %u gates%s, expected %u", gates, out_pin ? " and the OUT pin" : "",
+           this->capabilities_.gates);
+  this->capabilities_.set_layout(gates, out_pin);
+  this->apply_capabilities_();
+}
+
+void LD2412Component::apply_capabilities_() {
+  if (this->capabilities_.standard_layout()) {
+    this->handle_periodic_ = &LD2412Component::handle_periodic_data_;
+    return;
+  }
+  if (!this->normalized_frame_)
+    this->normalized_frame_.reset(new uint8_t[ENGINEERING_FRAME_SIZE + 1]);
+  this->handle_periodic_ = &LD2412Component::handle_normalized_periodic_data_;
+}
+
+void LD2412Component::handle_normalized_periodic_data_(uint8_t *buffer, int len) {
+  if (buffer[offsetof(PeriodicFrame, data_type)] != 0x01 || len != this->capabilities_.engineering_frame_size) {
+    this->handle_periodic_data_(buffer, len);
+    return;
   }
+  // Rebuild the frame in the 14 gates layout: missing gates read as 0, extra gates are dropped
+  const uint8_t gates = this->capabilities_.gates;
+  const uint8_t kept = std::min(gates, FRAME_GATES);
+  const uint8_t *energies = buffer + offsetof(EngineeringFrame, moving_energies);
+  uint8_t *normalized = this->normalized_frame_.get();
+  auto *frame = reinterpret_cast<EngineeringFrame *>(normalized);
+  std::memcpy(normalized, buffer, offsetof(EngineeringFrame, moving_energies));
+  std::memset(frame->moving_energies, 0, FRAME_GATES);
+  std::memset(frame->still_energies, 0, FRAME_GATES);
+  std::memcpy(frame->moving_energies, energies, kept);
+  std::memcpy(frame->still_energies, energies + gates, kept);
+  frame->light = energies[2 * gates];
+  size_t pos = sizeof(EngineeringFrame);
+  if (this->capabilities_.out_pin_in_frame)
+    normalized[pos++] = energies[2 * gates + 1];
+  normalized[pos++] = 0x55;
+  normalized[pos++] = 0x00;
+  std::memcpy(normalized + pos, DATA_FRAME_END, FRAME_FOOTER_SIZE);
+  pos += FRAME_FOOTER_SIZE;
+  uint16_t length = pos - sizeof(FrameHeader) - FRAME_FOOTER_SIZE;
+  frame->base.header.length[0] = lowbyte(length);
+  frame->base.header.length[1] = highbyte(length);
+  this->handle_periodic_data_(normalized, pos);
 }
+#endif
 
 void LD2412Component::send_command_(uint8_t command, const uint8_t *command_value, int command_value_len) {
+  this->write_command_(command, command_value, command_value_len);
+  LD2412_TRACE(TRACE_COMMAND_WAIT_BEGIN, command, 0);
+  // FIXME to remove
+  delay(50);  // NOLINT
+  LD2412_TRACE(TRACE_COMMAND_WAIT_END, command, 0);
+}
+
+void LD2412Component::write_command_(uint8_t command, const uint8_t *command_value, int command_value_len) {
   ESP_LOGV(TAG, "Sending COMMAND %02X", command);
+  LD2412_TRACE(TRACE_COMMAND, command, command_value != nullptr ? command_value_len : 0);
+#ifdef USE_LD2412_COMMAND_STATS
+  this->command_stats_.sent(lowbyte(command), micros());
+#endif
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+  // The ACK has to be read as soon as it comes
+  this->rx_next_check_millis_ = millis();
+#endif
   // frame start bytes
   this->write_array(CMD_FRAME_HEADER, 4);
   // length bytes
@@ -150,32 +696,69 @@ void LD2412Component::send_command_(uint8_t command, const uint8_t *command_valu
   }
   // frame end bytes
   this->write_array(CMD_FRAME_END, 4);
-  // FIXME to remove
-  delay(50);  // NOLINT
 }
 
 void LD2412Component::handle_periodic_data_(uint8_t *buffer, int len) {
-  if (len < 12)
-    return;  // 4 frame start bytes + 2 length bytes + 1 data end byte + 1 crc byte + 4 frame end bytes
-  if (buffer[0] != 0xF4 || buffer[1] != 0xF3 || buffer[2] != 0xF2 || buffer[3] != 0xF1)  // check 4 frame start bytes
+  // Length, header, data head=0xAA and data end=0x55 are checked once here, fields are read from the view
+#ifdef LD2412_FRAME_TIMESTAMPS
+  PeriodicFrameView frame(buffer, len, this->frame_timestamp_);
+#else
+  PeriodicFrameView frame(buffer, len);
+#endif
+  if (!frame.is_valid())
     return;
-  if (buffer[7] != HEAD || buffer[len - 6] != END)  // Check constant values
-    return;  // data head=0xAA, data end=0x55, crc=0x00
+#ifdef USE_LD2412_FRAME_TIMING
+  frame.set_interval(this->frame_timing_.add(frame.timestamp()));
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  this->feed_watchdog_();
+#endif
+
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  /*
+    Zone occupancy is evaluated on every frame so transitions are not delayed by the throttle
+  */
+  if (!this->zone_binary_sensors_.empty()) {
+    if (frame.is_engineering()) {
+      this->update_zone_occupancy_(frame.moving_energies(), frame.still_energies());
+    } else {
+      this->clear_zone_occupancy_();
+    }
+  }
+#endif
+
+#ifdef USE_LD2412_INTERFERENCE
+  this->update_interference_(frame);
+#endif
+#ifdef USE_LD2412_STATS
+  if (this->stats_key_ != 0)
+    this->update_stats_(frame);
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  if (this->low_power_)
+    this->update_low_power_(frame);
+#endif
 
   /*
     Reduce data update rate to prevent home assistant database size grow fast
   */
   int32_t current_millis = millis();
-  if (current_millis - last_periodic_millis_ < this->throttle_)
+  bool throttled = current_millis - last_periodic_millis_ < this->throttle_;
+#ifdef USE_LD2412_HISTORY
+  this->record_frame_(frame, throttled);
+#endif
+#ifdef USE_LD2412_STREAM
+  if (this->streamer_.is_configured())
+    this->streamer_.add_frame(frame);
+#endif
+#ifdef USE_LD2412_ON_FRAME
+  this->frame_callback_.call(frame);
+#endif
+  if (throttled)
     return;
   last_periodic_millis_ = current_millis;
 
-  /*
-    Data Type: 7th
-    0x01: Engineering mode
-    0x02: Normal mode
-  */
-  bool engineering_mode = buffer[DATA_TYPES] == 0x01;
+  bool engineering_mode = frame.is_engineering();
 #ifdef USE_SELECT
   if (this->mode_select_ != nullptr) {
     if(this->mode_select_->state == "Engineering" && !engineering_mode){
@@ -193,140 +776,193 @@ void LD2412Component::handle_periodic_data_(uint8_t *buffer, int len) {
 //    this->engineering_mode_switch_->publish_state(engineering_mode);
 //  }
 //#endif
-  char target_state = buffer[TARGET_STATES];
+  bool has_target = frame.has_target();
 #ifdef USE_BINARY_SENSOR
-  /*
-    Target states: 9th
-    0x00 = No target
-    0x01 = Moving targets
-    0x02 = Still targets
-    0x03 = Moving+Still targets
-  */
   if (this->target_binary_sensor_ != nullptr) {
-    this->target_binary_sensor_->publish_state(target_state != 0x00);
+    this->publish_(this->target_binary_sensor_, has_target, PUBLISH_PRESENCE);
   }
   if (this->moving_target_binary_sensor_ != nullptr) {
-    this->moving_target_binary_sensor_->publish_state(CHECK_BIT(target_state, 0));
+    this->publish_(this->moving_target_binary_sensor_, frame.has_moving_target(), PUBLISH_PRESENCE);
   }
   if (this->still_target_binary_sensor_ != nullptr) {
-    this->still_target_binary_sensor_->publish_state(CHECK_BIT(target_state, 1));
+    this->publish_(this->still_target_binary_sensor_, frame.has_still_target(), PUBLISH_PRESENCE);
   }
 #endif
-  /*
-    Moving target distance: 10~11th bytes
-    Moving target energy: 12th byte
-    Still target distance: 13~14th bytes
-    Still target energy: 15th byte
-    Detect distance: 16~17th bytes
-  */
 #ifdef USE_SENSOR
   if (this->moving_target_distance_sensor_ != nullptr) {
-    int new_moving_target_distance = target_state != 0x00 ? 
-      this->two_byte_to_int_(buffer[MOVING_TARGET_LOW], buffer[MOVING_TARGET_HIGH]) :
-      0;
-    if (this->moving_target_distance_sensor_->get_state() != new_moving_target_distance)
-      this->moving_target_distance_sensor_->publish_state(new_moving_target_distance);
+    int new_moving_target_distance = has_target ? this->calibrate_distance_(frame.moving_distance()) : 0;
+    this->publish_changed_(this->moving_target_distance_sensor_, new_moving_target_distance, PUBLISH_DISTANCE);
   }
   if (this->moving_target_energy_sensor_ != nullptr) {
-    int new_moving_target_energy = target_state != 0x00 ? 
-      buffer[MOVING_ENERGY] :
-      0;
-    if (this->moving_target_energy_sensor_->get_state() != new_moving_target_energy)
-      this->moving_target_energy_sensor_->publish_state(new_moving_target_energy);
+    int new_moving_target_energy = has_target ? frame.moving_energy() : 0;
+    this->publish_changed_(this->moving_target_energy_sensor_, new_moving_target_energy, PUBLISH_DISTANCE);
   }
   if (this->still_target_distance_sensor_ != nullptr) {
-    int new_still_target_distance = target_state != 0x00 ? 
-      this->two_byte_to_int_(buffer[STILL_TARGET_LOW], buffer[STILL_TARGET_HIGH]) : 
-      0;
-    if (this->still_target_distance_sensor_->get_state() != new_still_target_distance)
-      this->still_target_distance_sensor_->publish_state(new_still_target_distance);
+    int new_still_target_distance = has_target ? this->calibrate_distance_(frame.still_distance()) : 0;
+    this->publish_changed_(this->still_target_distance_sensor_, new_still_target_distance, PUBLISH_DISTANCE);
   }
   if (this->still_target_energy_sensor_ != nullptr) {
-    int new_still_target_energy = target_state != 0x00 ? 
-      buffer[STILL_ENERGY] : 
-      0;
-    if (this->still_target_energy_sensor_->get_state() != new_still_target_energy)
-      this->still_target_energy_sensor_->publish_state(new_still_target_energy);
+    int new_still_target_energy = has_target ? frame.still_energy() : 0;
+    this->publish_changed_(this->still_target_energy_sensor_, new_still_target_energy, PUBLISH_DISTANCE);
   }
   if (this->detection_distance_sensor_ != nullptr) {
-    int new_detect_distance = 0;
-    if(target_state != 0x00 && CHECK_BIT(target_state, 0)){
-      new_detect_distance = this->two_byte_to_int_(buffer[MOVING_TARGET_LOW], buffer[MOVING_TARGET_HIGH]);
-    }else if(target_state != 0x00){
-      new_detect_distance = this->two_byte_to_int_(buffer[STILL_TARGET_LOW], buffer[STILL_TARGET_HIGH]);
-    }
-    if (this->detection_distance_sensor_->get_state() != new_detect_distance)
-      this->detection_distance_sensor_->publish_state(new_detect_distance);
+    int new_detect_distance = has_target ? this->calibrate_distance_(frame.detection_distance()) : 0;
+    this->publish_changed_(this->detection_distance_sensor_, new_detect_distance, PUBLISH_DISTANCE);
   }
   if (engineering_mode) {
-    /*
-      Moving distance range: 18th byte
-      Still distance range: 19th byte
-      Moving enery: 20~28th bytes
-    */
-    for (std::vector<sensor::Sensor *>::size_type i = 0; i != this->gate_move_sensors_.size(); i++) {
-      sensor::Sensor *s = this->gate_move_sensors_[i];
-      if (s != nullptr) {
-        s->publish_state(buffer[MOVING_SENSOR_START + i]);
+#ifdef USE_LD2412_GATE_SENSORS
+    if (this->gate_move_sensor_mask_ != 0 || this->gate_still_sensor_mask_ != 0) {
+      // Only gates that changed since the last published frame, and that have a sensor
+      const GateVector moving = GateVector::load(frame.moving_energies());
+      const GateVector still = GateVector::load(frame.still_energies());
+      uint16_t moving_changed = this->gate_move_sensor_mask_;
+      uint16_t still_changed = this->gate_still_sensor_mask_;
+      if (this->gate_energies_published_) {
+        moving_changed &= moving.differs(this->last_moving_energies_);
+        still_changed &= still.differs(this->last_still_energies_);
       }
-    }
-    /*
-      Still energy: 29~37th bytes
-    */
-    for (std::vector<sensor::Sensor *>::size_type i = 0; i != this->gate_still_sensors_.size(); i++) {
-      sensor::Sensor *s = this->gate_still_sensors_[i];
-      if (s != nullptr) {
-        s->publish_state(buffer[STILL_SENSOR_START + i]);
+      for (; moving_changed != 0; moving_changed &= moving_changed - 1) {
+        uint8_t gate = __builtin_ctz(moving_changed);
+        this->publish_(this->gate_move_sensors_[gate], moving[gate], PUBLISH_DIAGNOSTIC);
+      }
+      for (; still_changed != 0; still_changed &= still_changed - 1) {
+        uint8_t gate = __builtin_ctz(still_changed);
+        this->publish_(this->gate_still_sensors_[gate], still[gate], PUBLISH_DIAGNOSTIC);
       }
+      this->last_moving_energies_ = moving;
+      this->last_still_energies_ = still;
+      this->gate_energies_published_ = true;
     }
-    /*
-      Light sensor: 38th bytes
-    */
+#endif
     if (this->light_sensor_ != nullptr) {
-      int new_light_sensor = (buffer[LIGHT_SENSOR]*100)/255;
-      if (this->light_sensor_->get_state() != new_light_sensor)
-        this->light_sensor_->publish_state(new_light_sensor);
+      int new_light_sensor = (frame.light() * 100) / 255;
+      this->publish_changed_(this->light_sensor_, new_light_sensor, PUBLISH_DIAGNOSTIC);
+    }
+#ifdef USE_LD2412_ZONE_ENERGY
+    if (!this->zone_energy_sensors_.empty()) {
+      this->update_zone_energies_(frame.moving_energies(), frame.still_energies());
     }
+#endif
   } 
   if(!engineering_mode) {
+#ifdef USE_LD2412_GATE_SENSORS
+    this->gate_energies_published_ = false;
     for (auto *s : this->gate_move_sensors_) {
-      if (s != nullptr && !std::isnan(s->get_state())) {
-        s->publish_state(NAN);
+      if (s != nullptr) {
+        this->publish_changed_(s, NAN, PUBLISH_DIAGNOSTIC);
       }
     }
     for (auto *s : this->gate_still_sensors_) {
-      if (s != nullptr && !std::isnan(s->get_state())) {
-        s->publish_state(NAN);
+      if (s != nullptr) {
+        this->publish_changed_(s, NAN, PUBLISH_DIAGNOSTIC);
       }
     }
-    if (this->light_sensor_ != nullptr && !std::isnan(this->light_sensor_->get_state())) {
-      this->light_sensor_->publish_state(NAN);
+#endif
+    if (this->light_sensor_ != nullptr) {
+      this->publish_changed_(this->light_sensor_, NAN, PUBLISH_DIAGNOSTIC);
     }
+#ifdef USE_LD2412_ZONE_ENERGY
+    for (auto *s : this->zone_energy_sensors_) {
+      this->publish_changed_(s, NAN, PUBLISH_DIAGNOSTIC);
+    }
+#endif
+  }
+#endif
+#ifdef USE_TEXT_SENSOR
+  if (this->gate_energies_text_sensor_ != nullptr) {
+    // One message for the whole frame instead of one per gate sensor
+    std::string energies =
+        engineering_mode ? encode_gate_energies(frame.moving_energies(), frame.still_energies(), frame.light()) : "";
+    if (this->gate_energies_text_sensor_->state != energies)
+      this->gate_energies_text_sensor_->publish_state(energies);
   }
-  //}
 #endif
 #ifdef USE_BINARY_SENSOR
-  if (engineering_mode) {
-    if (this->out_pin_presence_status_binary_sensor_ != nullptr) {
-      this->out_pin_presence_status_binary_sensor_->publish_state(buffer[OUT_PIN_SENSOR] == 0x01);
+  if (this->out_pin_presence_status_binary_sensor_ != nullptr) {
+    // Frames without the OUT pin byte leave the last known state
+    if (frame.has_out_pin()) {
+      this->publish_(this->out_pin_presence_status_binary_sensor_, frame.out_pin(), PUBLISH_PRESENCE);
+    } else if (!engineering_mode) {
+      this->publish_(this->out_pin_presence_status_binary_sensor_, false, PUBLISH_PRESENCE);
     }
+  }
+#endif
+}
+
+#ifdef USE_LD2412_HISTORY
+void LD2412Component::record_frame_(const PeriodicFrameView &frame, bool throttled) {
+  uint32_t now = millis();
+  FrameRecord record;
+  record.delta_ms = std::min(now - this->history_.last_millis(), HISTORY_MAX_DELTA_MS);
+  record.target_state = frame.target_state();
+  record.engineering_mode = frame.is_engineering();
+  record.throttled = throttled;
+  record.moving_distance = std::min(frame.moving_distance(), HISTORY_MAX_DISTANCE);
+  record.moving_energy = std::min(frame.moving_energy(), MAX_ENERGY);
+  record.still_distance = std::min(frame.still_distance(), HISTORY_MAX_DISTANCE);
+  record.still_energy = std::min(frame.still_energy(), MAX_ENERGY);
+#ifdef USE_LD2412_HISTORY_GATES
+  if (frame.is_engineering()) {
+    // moving energies, still energies and light are contiguous in the frame
+    memcpy(record.gates, frame.moving_energies(), HISTORY_GATE_BYTES);
   } else {
-    if (this->out_pin_presence_status_binary_sensor_ != nullptr) {
-      this->out_pin_presence_status_binary_sensor_->publish_state(false);
+    memset(record.gates, 0, HISTORY_GATE_BYTES);
+  }
+#endif
+  this->history_.push(record, now);
+}
+
+void LD2412Component::dump_history() {
+  size_t count = this->history_.size();
+  ESP_LOGI(TAG, "Frame history: %u frames", (unsigned) count);
+  // Records only store the delta with the previous one, the age of the oldest is the sum of the others
+  uint32_t age = 0;
+  for (size_t i = 1; i < count; i++) {
+    age += this->history_.at(i).delta_ms;
+  }
+  for (size_t i = 0; i < count; i++) {
+    const FrameRecord &record = this->history_.at(i);
+    if (i > 0)
+      age -= record.delta_ms;
+    ESP_LOGI(TAG, "  #%u -%ums state:%u eng:%u throttled:%u move:%ucm/%u%% still:%ucm/%u%%", (unsigned) i, (unsigned) age,
+             (unsigned) record.target_state, (unsigned) record.engineering_mode, (unsigned) record.throttled,
+             (unsigned) record.moving_distance, (unsigned) record.moving_energy, (unsigned) record.still_distance,
+             (unsigned) record.still_energy);
+#ifdef USE_LD2412_HISTORY_GATES
+    if (record.engineering_mode) {
+      uint8_t gates[HISTORY_GATE_BYTES];
+      memcpy(gates, record.gates, HISTORY_GATE_BYTES);
+      ESP_LOGI(TAG, "      gates: %s", format_buffer(gates, HISTORY_GATE_BYTES).c_str());
     }
+#endif
   }
+}
 #endif
+
+#ifdef USE_LD2412_TRACE
+// One line per event, tools/ld2412_trace.py turns the log into a Chrome trace
+void LD2412Component::dump_trace() {
+  size_t count = this->trace_.size();
+  ESP_LOGI(TAG, "Trace: %u events, %u lost, now %u", (unsigned) count, (unsigned) this->trace_.lost(),
+           (unsigned) micros());
+  for (size_t i = 0; i < count; i++) {
+    const TraceEvent &event = this->trace_.at(i);
+    ESP_LOGI(TAG, "  T %u %s %u %u", (unsigned) event.timestamp,
+             event.type < TRACE_EVENT_TYPES ? TRACE_EVENT_NAMES[event.type] : "unknown", (unsigned) event.arg,
+             (unsigned) event.value);
+  }
 }
+#endif
 
 const char VERSION_FMT[] = "%u.%02X.%02X%02X%02X%02X";
 
-std::string format_version(uint8_t *buffer) {
+std::string format_version(const AckVersionFrame *frame) {
   std::string::size_type version_size = 256;
   std::string version;
   do {
     version.resize(version_size + 1);
-    version_size = std::snprintf(&version[0], version.size(), VERSION_FMT, buffer[13], buffer[12], buffer[17],
-                                 buffer[16], buffer[15], buffer[14]);
+    version_size = std::snprintf(&version[0], version.size(), VERSION_FMT, frame->major[1], frame->major[0],
+                                 frame->minor[3], frame->minor[2], frame->minor[1], frame->minor[0]);
   } while (version_size + 1 > version.size());
   version.resize(version_size);
   return version;
@@ -337,13 +973,13 @@ const char MAC_FMT[] = "%02X:%02X:%02X:%02X:%02X:%02X";
 const std::string UNKNOWN_MAC("unknown");
 const std::string NO_MAC("08:05:04:03:02:01");
 
-std::string format_mac(uint8_t *buffer) {
+std::string format_mac(const AckMacFrame *frame) {
   std::string::size_type mac_size = 256;
   std::string mac;
   do {
     mac.resize(mac_size + 1);
-    mac_size = std::snprintf(&mac[0], mac.size(), MAC_FMT, buffer[10], buffer[11], buffer[12], buffer[13], buffer[14],
-                             buffer[15]);
+    mac_size = std::snprintf(&mac[0], mac.size(), MAC_FMT, frame->mac[0], frame->mac[1], frame->mac[2], frame->mac[3],
+                             frame->mac[4], frame->mac[5]);
   } while (mac_size + 1 > mac.size());
   mac.resize(mac_size);
   if (mac == NO_MAC) {
@@ -363,32 +999,81 @@ std::function<void(void)> set_number_value(number::Number *n, float value) {
 }
 #endif
 
-bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
-  ESP_LOGV(TAG, "Handling ACK DATA for COMMAND %02X", buffer[COMMAND]);
-  if (len < 10) {
-    ESP_LOGE(TAG, "Error with last command : incorrect length");
-    return true;
+#ifdef USE_LD2412_CAPABILITIES
+void LD2412Component::reject_command_(uint8_t command) {
+  // Before the version is known the error may come from the session itself (not in config mode)
+  if (this->capabilities_.firmware_major == 0)
+    return;
+  switch (command) {
+    case lowbyte(CMD_QUERY_LIGHT_CONTROL):
+    case lowbyte(CMD_SET_LIGHT_CONTROL):
+      if (this->capabilities_.light_control)
+        ESP_LOGW(TAG, "Light control not supported by firmware %s", this->version_.c_str());
+      this->capabilities_.light_control = false;
+      break;
+    case lowbyte(CMD_QUEY_DYNAMIC_BACKGROUND_CORRECTION):
+      if (this->capabilities_.background_query)
+        ESP_LOGW(TAG, "Background correction query not supported by firmware %s", this->version_.c_str());
+      this->capabilities_.background_query = false;
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+      // The correction is still tracked, on the expected duration only
+      if (this->background_correction_.state() == BACKGROUND_QUERYING) {
+        this->end_background_correction_session_();
+        this->background_correction_.reschedule(millis());
+      }
+#endif
+      break;
+    default:
+      break;
   }
-  if (buffer[0] != 0xFD || buffer[1] != 0xFC || buffer[2] != 0xFB || buffer[3] != 0xFA) {  // check 4 frame start bytes
-    ESP_LOGE(TAG, "Error with last command : incorrect Header %02X, %02X, %02X, %02X", buffer[0], buffer[1], buffer[2], buffer[3]);
-    //just a patch to handle a strange behavior. better this than have a costant wrong mode
-    if(this->dynamic_bakground_correction_active_){
-      this->query_dymanic_background_correction_();
-    }
-    return true;
+}
+#endif
+
+void LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
+  const AckFrame *ack = frame_cast<AckFrame>(buffer, len);
+  if (ack == nullptr) {
+    ESP_LOGE(TAG, "Error with last command : incorrect length");
+    this->count_ack_error_(ACK_TRUNCATED, COMMAND_UNKNOWN);
+    return;
   }
-  if (buffer[COMMAND_STATUS] != 0x01) {
+  ESP_LOGV(TAG, "Handling ACK DATA for COMMAND %02X", ack->command);
+  LD2412_TRACE(TRACE_ACK, ack->command | ack->result[0] << 8, ack->status);
+#ifdef USE_LD2412_COMMAND_STATS
+  // Dated when the parser completed the frame, by the RX task in rx_mode: task
+  uint32_t latency = this->command_stats_.acked(ack->command, this->frame_timestamp_);
+  ESP_LOGV(TAG, "COMMAND %02X round trip %uus", ack->command, (unsigned) latency);
+#endif
+  if (ack->status != 0x01) {
     ESP_LOGE(TAG, "Error with last command : status != 0x01");
-    return true;
+    this->count_ack_error_(ACK_BAD_STATUS, ack->command);
+#ifdef USE_LD2412_CAPABILITIES
+    this->reject_command_(ack->command);
+#endif
+    return;
   }
-  if (this->two_byte_to_int_(buffer[8], buffer[9]) != 0x00) {
-    ESP_LOGE(TAG, "Error with last command , last buffer was: %u , %u", buffer[8], buffer[9]);
-    return true;
+  if (le16(ack->result) != 0x00) {
+    ESP_LOGE(TAG, "Error with last command , last buffer was: %u , %u", ack->result[0], ack->result[1]);
+    this->count_ack_error_(ACK_NONZERO_RESULT, ack->command);
+#ifdef USE_LD2412_CAPABILITIES
+    this->reject_command_(ack->command);
+#endif
+    return;
   }
-  bool dynamic_background_correction_active;
-  switch (buffer[COMMAND]) {
+  switch (ack->command) {
     case lowbyte(CMD_ENABLE_CONF):
       ESP_LOGV(TAG, "Handled Enable conf command");
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+      if (this->background_correction_.state() == BACKGROUND_ENTERING_CONFIG) {
+        this->background_correction_.config_entered();
+        this->write_command_(CMD_QUEY_DYNAMIC_BACKGROUND_CORRECTION, nullptr, 0);
+      }
+#endif
+#ifdef USE_LD2412_WATCHDOG
+      if (this->watchdog_restart_pending_) {
+        this->watchdog_restart_pending_ = false;
+        this->write_command_(CMD_RESTART, nullptr, 0);
+      }
+#endif
       break;
     case lowbyte(CMD_DISABLE_CONF):
       ESP_LOGV(TAG, "Handled Disabled conf command");
@@ -401,19 +1086,38 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
       }
 #endif
       break;
-    case lowbyte(CMD_VERSION):
-      this->version_ = format_version(buffer);
+    case lowbyte(CMD_VERSION): {
+      const auto *frame = frame_cast<AckVersionFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
+      this->version_ = format_version(frame);
+#ifdef USE_LD2412_CAPABILITIES
+      this->capabilities_.update_from_version(frame);
+#endif
       ESP_LOGV(TAG, "FW Version is: %s", const_cast<char *>(this->version_.c_str()));
 #ifdef USE_TEXT_SENSOR
       if (this->version_text_sensor_ != nullptr) {
         this->version_text_sensor_->publish_state(this->version_);
       }
 #endif
-      break;
+    } break;
     case lowbyte(CMD_QUERY_DISTANCE_RESOLUTION): {
-      std::string distance_resolution =
-          DISTANCE_RESOLUTION_INT_TO_ENUM.at(this->two_byte_to_int_(buffer[10], buffer[11]));
-      ESP_LOGV(TAG, "Distance resolution is: %s", const_cast<char *>(distance_resolution.c_str()));
+      const auto *frame = frame_cast<AckDistanceResolutionFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
+      const char *distance_resolution = option_name(DISTANCE_RESOLUTION_OPTIONS, frame->resolution[0]);
+      if (frame->resolution[1] != 0x00 || distance_resolution == nullptr) {
+        ESP_LOGE(TAG, "Unknown distance resolution %02X%02X", frame->resolution[1], frame->resolution[0]);
+        break;
+      }
+      ESP_LOGV(TAG, "Distance resolution is: %s", distance_resolution);
+      this->apply_distance_resolution_(frame->resolution[0]);
 #ifdef USE_SELECT
       if (this->distance_resolution_select_ != nullptr &&
           this->distance_resolution_select_->state != distance_resolution) {
@@ -421,34 +1125,49 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
       }
 #endif
     } break;
-    //case lowbyte(CMD_QUERY_LIGHT_CONTROL): {
-    //  this->light_function_ = LIGHT_FUNCTION_INT_TO_ENUM.at(buffer[10]);
-    //  this->light_threshold_ = buffer[11] * 1.0;
-    //  this->out_pin_level_ = OUT_PIN_LEVEL_INT_TO_ENUM.at(buffer[12]);
-    //  ESP_LOGV(TAG, "Light function is: %s", const_cast<char *>(this->light_function_.c_str()));
-    //  ESP_LOGV(TAG, "Light threshold is: %f", this->light_threshold_);
-    //  ESP_LOGV(TAG, "Out pin level is: %s", const_cast<char *>(this->out_pin_level_.c_str()));
-    // #ifdef USE_SELECT
-    //       if (this->light_function_select_ != nullptr && this->light_function_select_->state != this->light_function_) {
-    //         this->light_function_select_->publish_state(this->light_function_);
-    //       }
-    //       if (this->out_pin_level_select_ != nullptr && this->out_pin_level_select_->state != this->out_pin_level_) {
-    //         this->out_pin_level_select_->publish_state(this->out_pin_level_);
-    //       }
-    // #endif
-    // #ifdef USE_NUMBER
-    //       if (this->light_threshold_number_ != nullptr &&
-    //           (!this->light_threshold_number_->has_state() ||
-    //            this->light_threshold_number_->state != this->light_threshold_)) {
-    //         this->light_threshold_number_->publish_state(this->light_threshold_);
-    //       }
-    // #endif
-    //     } break;
-    case lowbyte(CMD_MAC):
-      if (len < 20) {
-        return false;
-      }
-      this->mac_ = format_mac(buffer);
+    case lowbyte(CMD_QUERY_LIGHT_CONTROL): {
+      const auto *frame = frame_cast<AckLightControlFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
+      const char *light_function = option_name(LIGHT_FUNCTION_OPTIONS, frame->light_function);
+      const char *out_pin_level = option_name(OUT_PIN_LEVEL_OPTIONS, frame->out_pin_level);
+      if (light_function == nullptr || out_pin_level == nullptr) {
+        ESP_LOGE(TAG, "Unknown light control %02X, out pin level %02X", frame->light_function, frame->out_pin_level);
+        break;
+      }
+      this->light_function_ = frame->light_function;
+      this->light_threshold_ = frame->light_threshold;
+      this->out_pin_level_ = frame->out_pin_level;
+      ESP_LOGV(TAG, "Light function is: %s", light_function);
+      ESP_LOGV(TAG, "Light threshold is: %f", this->light_threshold_);
+      ESP_LOGV(TAG, "Out pin level is: %s", out_pin_level);
+#ifdef USE_SELECT
+      if (this->light_function_select_ != nullptr && this->light_function_select_->state != light_function) {
+        this->light_function_select_->publish_state(light_function);
+      }
+      if (this->out_pin_level_select_ != nullptr && this->out_pin_level_select_->state != out_pin_level) {
+        this->out_pin_level_select_->publish_state(out_pin_level);
+      }
+#endif
+#ifdef USE_NUMBER
+      if (this->light_threshold_number_ != nullptr &&
+          (!this->light_threshold_number_->has_state() ||
+           this->light_threshold_number_->state != this->light_threshold_)) {
+        this->light_threshold_number_->publish_state(this->light_threshold_);
+      }
+#endif
+    } break;
+    case lowbyte(CMD_MAC): {
+      const auto *frame = frame_cast<AckMacFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
+      this->mac_ = format_mac(frame);
       ESP_LOGV(TAG, "MAC Address is: %s", const_cast<char *>(this->mac_.c_str()));
 #ifdef USE_TEXT_SENSOR
       if (this->mac_text_sensor_ != nullptr) {
@@ -460,42 +1179,45 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
         this->bluetooth_switch_->publish_state(this->mac_ != UNKNOWN_MAC);
       }
 #endif
-      break;
+    } break;
     case lowbyte(CMD_SET_DISTANCE_RESOLUTION):
       ESP_LOGV(TAG, "Handled set distance resolution command");
       break;
-    case lowbyte(CMD_QUEY_DYNAMIC_BACKGROUND_CORRECTION):
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+    case lowbyte(CMD_QUEY_DYNAMIC_BACKGROUND_CORRECTION): {
       ESP_LOGV(TAG, "Handled query dynamic background correction");
-      dynamic_background_correction_active = (buffer[10] == 0x01);
-#ifdef USE_SELECT
-      if(this->dynamic_bakground_correction_active_ != dynamic_background_correction_active && dynamic_background_correction_active){
-        this->mode_select_->publish_state("Dynamic background correction");
-      }else if(this->dynamic_bakground_correction_active_ != dynamic_background_correction_active && !dynamic_background_correction_active){
-        this->mode_select_->publish_state("Normal");
+      const auto *frame = frame_cast<AckBackgroundCorrectionFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
       }
+      this->handle_background_correction_ack_(frame->active[0] == 0x01);
+    } break;
 #endif
-      this->dynamic_bakground_correction_active_ = dynamic_background_correction_active;
-      if(this->dynamic_bakground_correction_active_){
-        this->set_timeout(1000, [this]() { this->query_dymanic_background_correction_(); });
-      }
-      break;
 //    case lowbyte(CMD_GATE_SENS):
 //      ESP_LOGV(TAG, "Handled sensitivity command");
 //      break;
 //    case lowbyte(CMD_BLUETOOTH):
 //      ESP_LOGV(TAG, "Handled bluetooth command");
 //      break;
-//    case lowbyte(CMD_SET_LIGHT_CONTROL):
-//      ESP_LOGV(TAG, "Handled set light control command");
-//      break;
+    case lowbyte(CMD_SET_LIGHT_CONTROL):
+      ESP_LOGV(TAG, "Handled set light control command");
+      break;
 //    case lowbyte(CMD_BT_PASSWORD):
 //      ESP_LOGV(TAG, "Handled set bluetooth password command");
 //      break;
     case lowbyte(CMD_QUERY_MOTION_GATE_SENS):{
+      const auto *frame = frame_cast<AckGateSensitivityFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
       std::vector<std::function<void(void)>> updates;
 #ifdef USE_NUMBER
-      for(int i = 0; i < this->gate_still_threshold_numbers_.size(); i++){
-        updates.push_back(set_number_value(this->gate_move_threshold_numbers_[i], buffer[10+i]));
+      for(int i = 0; i < this->gate_move_threshold_numbers_.size(); i++){
+        updates.push_back(set_number_value(this->gate_move_threshold_numbers_[i], frame->gates[i]));
       }
 #endif
       for (auto &update : updates) {
@@ -504,10 +1226,16 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
       break;
     }
     case lowbyte(CMD_QUERY_STATIC_GATE_SENS):{
+      const auto *frame = frame_cast<AckGateSensitivityFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
       std::vector<std::function<void(void)>> updates;
 #ifdef USE_NUMBER
       for(int i = 0; i < this->gate_still_threshold_numbers_.size(); i++){
-        updates.push_back(set_number_value(this->gate_still_threshold_numbers_[i], buffer[10+i]));
+        updates.push_back(set_number_value(this->gate_still_threshold_numbers_[i], frame->gates[i]));
       }
 #endif
       for (auto &update : updates) {
@@ -517,27 +1245,40 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
     }
     case lowbyte(CMD_QUERY):  // Query parameters response
     {
+      const auto *frame = frame_cast<AckQueryFrame>(buffer, len);
+      if (frame == nullptr) {
+        ESP_LOGE(TAG, "Error with last command : incorrect length");
+        this->count_ack_error_(ACK_TRUNCATED, ack->command);
+        break;
+      }
 #ifdef USE_NUMBER
       /*
         Moving distance range: 9th byte
         Still distance range: 10th byte
       */
       std::vector<std::function<void(void)>> updates;
-      updates.push_back(set_number_value(this->min_distance_gate_number_, buffer[10]));
-      updates.push_back(set_number_value(this->max_distance_gate_number_, buffer[11]-1));
-      ESP_LOGV(TAG, "min_distance_gate_number_: %u, max_distance_gate_number_ %u", buffer[10], buffer[11]);
+      updates.push_back(set_number_value(this->min_distance_gate_number_, frame->min_distance_gate));
+      updates.push_back(set_number_value(this->max_distance_gate_number_, frame->max_distance_gate - 1));
+      ESP_LOGV(TAG, "min_distance_gate_number_: %u, max_distance_gate_number_ %u", frame->min_distance_gate,
+               frame->max_distance_gate);
       /*
         None Duration: 11~12th bytes
       */
-      updates.push_back(set_number_value(this->timeout_number_, this->two_byte_to_int_(buffer[12], buffer[13])));
-      ESP_LOGV(TAG, "timeout_number_: %u", this->two_byte_to_int_(buffer[12], buffer[13]));
+      updates.push_back(set_number_value(this->timeout_number_, le16(frame->duration)));
+      ESP_LOGV(TAG, "timeout_number_: %u", le16(frame->duration));
       /*
         Output pin configuration: 13th bytes
       */
-      this->out_pin_level_ = OUT_PIN_LEVEL_INT_TO_ENUM.at(buffer[14]);
+      if (option_name(OUT_PIN_LEVEL_OPTIONS, frame->out_pin_level) != nullptr) {
+        this->out_pin_level_ = frame->out_pin_level;
+      } else {
+        ESP_LOGE(TAG, "Unknown out pin level %02X", frame->out_pin_level);
+      }
 #ifdef USE_SELECT
-      if (this->out_pin_level_select_ != nullptr && this->out_pin_level_select_->state != this->out_pin_level_) {
-        this->out_pin_level_select_->publish_state(this->out_pin_level_);
+      const char *out_pin_level = option_name(OUT_PIN_LEVEL_OPTIONS, this->out_pin_level_);
+      if (this->out_pin_level_select_ != nullptr && out_pin_level != nullptr &&
+          this->out_pin_level_select_->state != out_pin_level) {
+        this->out_pin_level_select_->publish_state(out_pin_level);
       }
 #endif
       /*
@@ -561,65 +1302,47 @@ bool LD2412Component::handle_ack_data_(uint8_t *buffer, int len) {
       break;
   }
 
-  return true;
 }
 
-void LD2412Component::readline_(int readch, uint8_t *buffer, int len) {
-  static int pos = 0;
-
-  if (readch >= 0) {
-    if(pos == 0 && readch != DATA_FRAME_HEADER[0] && readch != CMD_FRAME_HEADER[0]){
-      return;
-    }
-    if(pos == 1 && readch != DATA_FRAME_HEADER[1] && readch != CMD_FRAME_HEADER[1]){
-      pos = 0;
-      return;
-    }
-    if(pos == 2 && readch != DATA_FRAME_HEADER[2] && readch != CMD_FRAME_HEADER[2]){
-      pos = 0;
-      return;
-    }
-    if(pos == 3 && readch != DATA_FRAME_HEADER[3] && readch != CMD_FRAME_HEADER[3]){
-      pos = 0;
-      return;
-    }
-    if (pos < len - 1) {
-      buffer[pos++] = readch;
-      buffer[pos] = 0;
-    } else {
-      pos = 0;
-    }
-    if (pos >= 4) {
-      if (
-        buffer[pos - 4] == DATA_FRAME_END[0] && 
-        buffer[pos - 3] == DATA_FRAME_END[1] && 
-        buffer[pos - 2] == DATA_FRAME_END[2] && 
-        buffer[pos - 1] == DATA_FRAME_END[3]
-      ) {
-        ESP_LOGV(TAG, "Will handle Periodic Data:  %s", format_buffer(buffer, pos).c_str());
-        this->handle_periodic_data_(buffer, pos);
-        pos = 0;  // Reset position index ready for next time
-      } else if (
-        buffer[pos - 4] == CMD_FRAME_END[0] && 
-        buffer[pos - 3] == CMD_FRAME_END[1] && 
-        buffer[pos - 2] == CMD_FRAME_END[2] && 
-        buffer[pos - 1] == CMD_FRAME_END[3]
-      ) {
-        ESP_LOGV(TAG, "Will handle ACK Data");
-        if (this->handle_ack_data_(buffer, pos)) {
-          pos = 0;  // Reset position index ready for next time
-        } else {
-          ESP_LOGV(TAG, "ACK Data incomplete");
-        }
-      }
-    }
+// Feeds the frame parser, returns the frame length once a complete frame is in buffer, 0 otherwise
+int LD2412Component::readline_(int readch, uint8_t *buffer, int len) {
+  if (readch < 0)
+    return 0;
+  int frame_len = this->rx_parser_.feed(readch, buffer, len);
+#ifdef USE_LD2412_COMMAND_STATS
+  // Counted into the statistics by the loop, this may run in the RX task
+  if (frame_len < 0 && buffer[0] == CMD_FRAME_HEADER[0])
+    this->rx_bad_acks_++;
+#endif
+  switch (frame_len) {
+    case FRAME_INCOMPLETE:
+      return 0;
+    case FRAME_BAD_LENGTH:
+      ESP_LOGV(TAG, "Dropping frame with invalid length %d", FrameParser::frame_length(buffer));
+      return 0;
+    case FRAME_BAD_FOOTER:
+      ESP_LOGV(TAG, "Dropping frame with invalid footer: %s",
+               format_buffer(buffer, FrameParser::frame_length(buffer)).c_str());
+      return 0;
+    default:
+      break;
   }
+#ifdef LD2412_FRAME_TIMESTAMPS
+  // Bytes already buffered behind the footer arrived after it
+  this->rx_frame_timestamp_ = micros() - this->available() * this->rx_byte_micros_;
+#endif
+  return frame_len;
 }
 
 void LD2412Component::set_config_mode_(bool enable) {
   uint8_t cmd = enable ? CMD_ENABLE_CONF : CMD_DISABLE_CONF;
   uint8_t cmd_value[2] = {0x01, 0x00};
   this->send_command_(cmd, enable ? cmd_value : nullptr, 2);
+#ifdef USE_LD2412_WATCHDOG
+  // No frames are sent in config mode, give the module a full timeout to resume
+  if (!enable)
+    this->watchdog_frame_millis_ = millis();
+#endif
 }
 
 void LD2412Component::set_bluetooth(bool enable) {
@@ -631,23 +1354,38 @@ void LD2412Component::set_bluetooth(bool enable) {
 }
 
 void LD2412Component::set_distance_resolution(const std::string &state) {
+  const EnumOption *resolution = find_option(DISTANCE_RESOLUTION_OPTIONS, state);
+  if (resolution == nullptr) {
+    ESP_LOGE(TAG, "Unknown distance resolution %s", state.c_str());
+    return;
+  }
   this->set_config_mode_(true);
-  uint8_t cmd_value[6] = {DISTANCE_RESOLUTION_ENUM_TO_INT.at(state), 0x00, 0x00, 0x00, 0x00, 0x00};
+  uint8_t cmd_value[6] = {resolution->value, 0x00, 0x00, 0x00, 0x00, 0x00};
   this->send_command_(CMD_SET_DISTANCE_RESOLUTION, cmd_value, 6);
   this->set_timeout(200, [this]() { this->restart_and_read_all_info(); });
 }
 
 void LD2412Component::set_baud_rate(const std::string &state) {
+  const EnumOption *baud_rate = find_option(BAUD_RATE_OPTIONS, state);
+  if (baud_rate == nullptr) {
+    ESP_LOGE(TAG, "Unknown baud rate %s", state.c_str());
+    return;
+  }
   this->set_config_mode_(true);
-  uint8_t cmd_value[2] = {BAUD_RATE_ENUM_TO_INT.at(state), 0x00};
+  uint8_t cmd_value[2] = {baud_rate->value, 0x00};
   this->send_command_(CMD_SET_BAUD_RATE, cmd_value, 2);
   this->set_timeout(200, [this]() { this->restart_(); });
 }
 
 void LD2412Component::set_mode(const std::string &state) {
+  const EnumOption *mode = find_option(MODE_OPTIONS, state);
+  if (mode == nullptr) {
+    ESP_LOGE(TAG, "Unknown mode %s", state.c_str());
+    return;
+  }
   this->set_config_mode_(true);
   uint8_t cmd = CMD_NONE;
-  switch(MODE_ENUM_TO_INT.at(state)){
+  switch(mode->value){
     case NORMAL_MODE:
       cmd = CMD_DISABLE_ENG;
       break;
@@ -661,19 +1399,127 @@ void LD2412Component::set_mode(const std::string &state) {
   if(cmd != CMD_NONE){
     this->send_command_(cmd, nullptr, 0);
     this->set_config_mode_(false);
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
     if(cmd == CMD_DYNAMIC_BACKGROUND_CORRECTION){
-      this->dynamic_bakground_correction_active_ = true;
-      this->set_timeout(1000, [this]() { this->query_dymanic_background_correction_(); });
+      this->start_background_correction_();
     }
+#endif
   }
 }
 
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+// Inside the config mode session of the caller
 void LD2412Component::query_dymanic_background_correction_(){
-  this->set_config_mode_(true);
+#ifdef USE_LD2412_CAPABILITIES
+  if (!this->capabilities_.background_query)
+    return;
+#endif
   this->send_command_(CMD_QUEY_DYNAMIC_BACKGROUND_CORRECTION, nullptr, 0);
-  this->set_config_mode_(false);
 }
 
+void LD2412Component::start_background_correction_() {
+  ESP_LOGI(TAG, "Background correction started, expected to take %us",
+           this->background_correction_.get_expected_duration() / 1000);
+  this->background_correction_.start(millis());
+  this->publish_background_correction_();
+}
+
+/*
+  Runs from the loop while a correction is tracked. Each query is one config mode session,
+  advanced by its ACKs instead of delays: enable config mode, query, disable config mode.
+  Frames keep being read and decoded between the steps.
+*/
+void LD2412Component::update_background_correction_() {
+  BackgroundCorrection &correction = this->background_correction_;
+  if (!correction.active())
+    return;
+  uint32_t now = millis();
+  if (correction.session_timed_out(now)) {
+    ESP_LOGD(TAG, "Background correction query unanswered, retrying later");
+    this->end_background_correction_session_();
+    correction.reschedule(now);
+  }
+  if (correction.given_up(now)) {
+    ESP_LOGW(TAG, "Background correction still running after %us, no longer tracked", correction.elapsed(now) / 1000);
+    if (correction.in_session())
+      this->end_background_correction_session_();
+    this->finish_background_correction_(false);
+    return;
+  }
+  if (!correction.poll_due(now))
+    return;
+#ifdef USE_LD2412_CAPABILITIES
+  if (!this->capabilities_.background_query) {
+    // The module cannot be asked, the correction is taken as done after the expected duration
+    if (correction.remaining(now) == 0)
+      this->finish_background_correction_(true);
+    return;
+  }
+#endif
+  correction.begin_session(now);
+  uint8_t cmd_value[2] = {0x01, 0x00};
+  this->write_command_(CMD_ENABLE_CONF, cmd_value, 2);
+}
+
+void LD2412Component::handle_background_correction_ack_(bool active) {
+  BackgroundCorrection &correction = this->background_correction_;
+  // Answers to read_all_info come inside its own session, only ours is closed here
+  if (correction.state() == BACKGROUND_QUERYING)
+    this->end_background_correction_session_();
+  if (!active) {
+    if (correction.active())
+      this->finish_background_correction_(true);
+    return;
+  }
+  if (correction.active()) {
+    correction.reschedule(millis());
+    return;
+  }
+  // Started before our own setup, or from another client
+  ESP_LOGI(TAG, "Background correction in progress");
+  correction.start(millis());
+#ifdef USE_SELECT
+  if (this->mode_select_ != nullptr)
+    this->mode_select_->publish_state("Dynamic background correction");
+#endif
+  this->publish_background_correction_();
+}
+
+void LD2412Component::end_background_correction_session_() {
+  this->write_command_(CMD_DISABLE_CONF, nullptr, 0);
+#ifdef USE_LD2412_WATCHDOG
+  this->watchdog_frame_millis_ = millis();
+#endif
+}
+
+void LD2412Component::finish_background_correction_(bool completed) {
+  uint32_t duration = this->background_correction_.finish(millis(), completed);
+#ifdef USE_SELECT
+  if (this->mode_select_ != nullptr)
+    this->mode_select_->publish_state("Normal");
+#endif
+  this->publish_background_correction_();
+  if (!completed)
+    return;
+  ESP_LOGI(TAG, "Background correction done in %us", duration / 1000);
+  this->background_correction_callback_.call(duration);
+}
+
+void LD2412Component::publish_background_correction_() {
+#ifdef USE_SENSOR
+  const BackgroundCorrection &correction = this->background_correction_;
+  uint32_t now = millis();
+  if (this->background_correction_progress_sensor_ != nullptr)
+    this->publish_changed_(this->background_correction_progress_sensor_, roundf(correction.progress(now)),
+                           PUBLISH_DIAGNOSTIC);
+  if (this->background_correction_remaining_sensor_ != nullptr) {
+    uint32_t remaining = correction.active() ? (correction.remaining(now) + 999) / 1000 : 0;
+    this->publish_changed_(this->background_correction_remaining_sensor_, remaining, PUBLISH_DIAGNOSTIC);
+  }
+#endif
+}
+#endif
+
 // void LD2412Component::set_bluetooth_password(const std::string &password) {
 //   if (password.length() != 6) {
 //     ESP_LOGE(TAG, "set_bluetooth_password(): invalid password length, must be exactly 6 chars '%s'", password.c_str());
@@ -715,7 +1561,13 @@ void LD2412Component::get_mac_() {
 }
 void LD2412Component::get_distance_resolution_() { this->send_command_(CMD_QUERY_DISTANCE_RESOLUTION, nullptr, 0); }
 
-// void LD2412Component::get_light_control_() { this->send_command_(CMD_QUERY_LIGHT_CONTROL, nullptr, 0); }
+void LD2412Component::get_light_control_() {
+#ifdef USE_LD2412_CAPABILITIES
+  if (!this->capabilities_.light_control)
+    return;
+#endif
+  this->send_command_(CMD_QUERY_LIGHT_CONTROL, nullptr, 0);
+}
 
 #if !defined(USE_NUMBER) && defined(USE_SELECT)
 void LD2412Component::set_basic_config() {
@@ -729,8 +1581,11 @@ void LD2412Component::set_basic_config() {
   if (
       !this->min_distance_gate_number_->has_state() || 
       !this->max_distance_gate_number_->has_state() ||
-      !this->timeout_number_->has_state() ||
-      !this->out_pin_level_select_->has_state()) {
+      !this->timeout_number_->has_state()) {
+    return;
+  }
+  if (this->out_pin_level_ == OPTION_UNKNOWN) {
+    ESP_LOGW(TAG, "Out pin level not known yet, not sending basic config");
     return;
   }
   uint8_t value[5] = {
@@ -738,7 +1593,7 @@ void LD2412Component::set_basic_config() {
     lowbyte(static_cast<int>(this->max_distance_gate_number_->state)+1),
     lowbyte(static_cast<int>(this->timeout_number_->state)),
     highbyte(static_cast<int>(this->timeout_number_->state)),
-    OUT_PIN_LEVEL_ENUM_TO_INT.at(this->out_pin_level_select_->state)
+    this->out_pin_level_
   };
   // int max_moving_distance_gate_range = static_cast<int>(this->max_move_distance_gate_number_->state);
   // int max_still_distance_gate_range = static_cast<int>(this->max_still_distance_gate_number_->state);
@@ -764,6 +1619,8 @@ void LD2412Component::set_basic_config() {
   this->set_config_mode_(true);
   this->send_command_(CMD_BASIC_CONF, value, 5);
   delay(50);  // NOLINT
+  this->query_parameters_();
+  delay(10);  // NOLINT
   this->set_config_mode_(false);
 }
 
@@ -804,36 +1661,522 @@ void LD2412Component::set_gate_move_threshold_number(int gate, number::Number *n
 #endif
 
 void LD2412Component::set_light_out_control() {
-// #ifdef USE_NUMBER
-//   if (this->light_threshold_number_ != nullptr && this->light_threshold_number_->has_state()) {
-//     this->light_threshold_ = this->light_threshold_number_->state;
-//   }
-// #endif
+#ifdef USE_NUMBER
+  if (this->light_threshold_number_ != nullptr && this->light_threshold_number_->has_state()) {
+    this->light_threshold_ = this->light_threshold_number_->state;
+  }
+#endif
 #ifdef USE_SELECT
-//   if (this->light_function_select_ != nullptr && this->light_function_select_->has_state()) {
-//     this->light_function_ = this->light_function_select_->state;
-//   }
+  if (this->light_function_select_ != nullptr && this->light_function_select_->has_state()) {
+    const EnumOption *light_function = find_option(LIGHT_FUNCTION_OPTIONS, this->light_function_select_->state);
+    if (light_function != nullptr)
+      this->light_function_ = light_function->value;
+  }
   if (this->out_pin_level_select_ != nullptr && this->out_pin_level_select_->has_state()) {
-    this->out_pin_level_ = this->out_pin_level_select_->state;
+    const EnumOption *out_pin_level = find_option(OUT_PIN_LEVEL_OPTIONS, this->out_pin_level_select_->state);
+    if (out_pin_level != nullptr)
+      this->out_pin_level_ = out_pin_level->value;
   }
 #endif
-  if (this->light_function_.empty() || this->out_pin_level_.empty() || this->light_threshold_ < 0) {
+  if (this->light_function_ == OPTION_UNKNOWN || this->out_pin_level_ == OPTION_UNKNOWN || this->light_threshold_ < 0) {
+    ESP_LOGW(TAG, "Light control not known yet, not sending it");
     return;
   }
+#ifdef USE_LD2412_CAPABILITIES
+  if (!this->capabilities_.light_control) {
+    ESP_LOGW(TAG, "Light control not supported by firmware %s", this->version_.c_str());
+    return;
+  }
+#endif
+  // The module applies the new values at once, reading them back confirms them without a restart
+  uint8_t value[4] = {this->light_function_, static_cast<uint8_t>(clamp(this->light_threshold_, 0.0f, 255.0f)),
+                      this->out_pin_level_, 0x00};
   this->set_config_mode_(true);
-  // uint8_t light_function = LIGHT_FUNCTION_ENUM_TO_INT.at(this->light_function_);
-  // uint8_t light_threshold = static_cast<uint8_t>(this->light_threshold_);
-  // uint8_t out_pin_level = OUT_PIN_LEVEL_ENUM_TO_INT.at(this->out_pin_level_);
-  // uint8_t value[4] = {light_function, light_threshold, out_pin_level, 0x00};
-  // this->send_command_(CMD_SET_LIGHT_CONTROL, value, 4);
-  // delay(50);  // NOLINT
-  // this->get_light_control_();
-  this->set_timeout(200, [this]() { this->restart_and_read_all_info(); });
+  this->send_command_(CMD_SET_LIGHT_CONTROL, value, 4);
+  delay(50);  // NOLINT
+  this->get_light_control_();
+  delay(10);  // NOLINT
+  this->set_config_mode_(false);
+}
+
+#ifdef USE_LD2412_INTERFERENCE
+void LD2412Component::update_interference_(const PeriodicFrameView &frame) {
+  if (!frame.is_engineering())
+    return;
+  if (!this->interference_.add_frame(frame.moving_energies(), millis()))
+    return;
+  bool detected = this->interference_.is_detected();
+  if (detected) {
+#ifdef USE_LD2412_FRAME_TIMING
+    ESP_LOGW(TAG, "Interference detected: %.2f events/s, last spiking gates %04X, frame jitter %.1fms",
+             this->interference_.event_rate(), this->interference_.last_spikes(),
+             this->frame_timing_.jitter() / 1000);
+#else
+    ESP_LOGW(TAG, "Interference detected: %.2f events/s, last spiking gates %04X", this->interference_.event_rate(),
+             this->interference_.last_spikes());
+#endif
+    for (uint8_t gate = 0; gate < INTERFERENCE_GATES; gate++) {
+      ESP_LOGD(TAG, "  g%u mean %.1f variance %.1f spike rate %.2f", gate, this->interference_.gate_mean(gate),
+               this->interference_.gate_variance(gate), this->interference_.gate_spike_rate(gate));
+    }
+  } else {
+    ESP_LOGI(TAG, "Interference cleared");
+  }
+#ifdef USE_BINARY_SENSOR
+  if (this->interference_binary_sensor_ != nullptr)
+    this->publish_(this->interference_binary_sensor_, detected, PUBLISH_DIAGNOSTIC);
+#endif
 }
+#endif
 
+#ifdef USE_LD2412_COMMAND_STATS
+void LD2412Component::count_ack_error_(AckError error, uint8_t command) {
+  this->command_stats_.error(error, command);
 #ifdef USE_SENSOR
-void LD2412Component::set_gate_move_sensor(int gate, sensor::Sensor *s) { this->gate_move_sensors_[gate] = s; }
-void LD2412Component::set_gate_still_sensor(int gate, sensor::Sensor *s) { this->gate_still_sensors_[gate] = s; }
+  if (this->ack_error_sensors_[error] != nullptr)
+    this->publish_(this->ack_error_sensors_[error], this->command_stats_.errors(error), PUBLISH_DIAGNOSTIC);
+#endif
+}
+
+void LD2412Component::dump_command_stats() {
+  ESP_LOGI(TAG, "Command statistics: %u ACKs, mean %.1fms, max %.1fms", (unsigned) this->command_stats_.count(),
+           this->command_stats_.mean() / 1000, this->command_stats_.max() / 1000.0f);
+  for (uint8_t error = 0; error < ACK_ERROR_TYPES; error++) {
+    ESP_LOGI(TAG, "  %s: %u", ACK_ERROR_NAMES[error], (unsigned) this->command_stats_.errors(static_cast<AckError>(error)));
+  }
+  ESP_LOGI(TAG, "  round trip buckets (ms): <=2 <=5 <=10 <=20 <=50 <=100 <=200 >200");
+  for (uint8_t i = 0; i < this->command_stats_.size(); i++) {
+    const CommandLatency &slot = this->command_stats_.at(i);
+    float mean = slot.count == 0 ? 0 : float(slot.total_us) / slot.count / 1000;
+    ESP_LOGI(TAG, "  %02X: %u ACKs, mean %.1fms, max %.1fms, %u errors | %u %u %u %u %u %u %u %u", slot.command,
+             (unsigned) slot.count, mean, slot.max_us / 1000.0f, slot.errors, slot.buckets[0], slot.buckets[1],
+             slot.buckets[2], slot.buckets[3], slot.buckets[4], slot.buckets[5], slot.buckets[6], slot.buckets[7]);
+  }
+}
+#endif
+
+#ifdef USE_LD2412_LOW_POWER
+/*
+  Light sleeps until shortly before the next expected frame. The UART does not receive
+  while asleep, so nothing is pending when going to sleep, and ACK driven sessions keep
+  the SoC awake. Other components only run between sleeps, at most max_sleep apart.
+*/
+void LD2412Component::light_sleep_() {
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  if (this->background_correction_.active())
+    return;
+#endif
+  if (this->available() > 0)
+    return;
+  uint32_t sleep = this->sleep_planner_.sleep_time(micros(), this->frame_timing_.last_timestamp(),
+                                                   this->frame_timing_.mean(), this->frame_timing_.jitter());
+  if (sleep == 0)
+    return;
+#ifdef USE_ESP_IDF
+  auto uart_num = static_cast<uart_port_t>(static_cast<uart::IDFUARTComponent *>(this->parent_)->get_hw_serial_number());
+#else
+  auto uart_num =
+      static_cast<uart_port_t>(static_cast<uart::ESP32ArduinoUARTComponent *>(this->parent_)->get_hw_serial_number());
+#endif
+  esp_sleep_enable_timer_wakeup(sleep);
+  // An early frame or an unexpected ACK wakes it up, its first bytes are lost
+  uart_set_wakeup_threshold(uart_num, 3);
+  esp_sleep_enable_uart_wakeup(uart_num);
+  gpio_num_t pin = GPIO_NUM_0;
+  if (this->wake_pin_ != nullptr) {
+    // Level triggered: wakes up when the OUT pin leaves its current level
+    pin = static_cast<gpio_num_t>(this->wake_pin_->get_pin());
+    gpio_wakeup_enable(pin, gpio_get_level(pin) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+  }
+  uint32_t start = micros();
+  esp_light_sleep_start();
+  uint32_t slept = micros() - start;
+  if (this->wake_pin_ != nullptr)
+    gpio_wakeup_disable(pin);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+  WakeCause cause;
+  switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER:
+      cause = WAKE_TIMER;
+      break;
+    case ESP_SLEEP_WAKEUP_UART:
+      cause = WAKE_UART;
+      break;
+    case ESP_SLEEP_WAKEUP_GPIO:
+      cause = WAKE_PIN;
+      break;
+    default:
+      cause = WAKE_OTHER;
+      break;
+  }
+  this->sleep_planner_.add_sleep(slept, cause);
+  if (cause == WAKE_PIN && this->engineering_parked_) {
+    ESP_LOGD(TAG, "OUT pin changed, engineering mode back on");
+    this->park_engineering_mode_(false);
+  }
+}
+
+/*
+  With stable_time, engineering mode is turned off once the target state has not changed
+  for that long, and back on as soon as it changes.
+*/
+void LD2412Component::update_low_power_(const PeriodicFrameView &frame) {
+  if (this->low_power_stable_time_ == 0)
+    return;
+  uint32_t now = millis();
+  bool has_target = frame.has_target();
+  if (has_target != this->low_power_target_) {
+    this->low_power_target_ = has_target;
+    this->low_power_target_millis_ = now;
+    if (this->engineering_parked_) {
+      ESP_LOGD(TAG, "Target changed, engineering mode back on");
+      this->park_engineering_mode_(false);
+    }
+    return;
+  }
+  if (frame.is_engineering() && !this->engineering_parked_ &&
+      now - this->low_power_target_millis_ >= this->low_power_stable_time_) {
+    ESP_LOGD(TAG, "Target stable for %us, engineering mode off", (unsigned) ((now - this->low_power_target_millis_) / 1000));
+    this->park_engineering_mode_(true);
+  }
+}
+
+void LD2412Component::park_engineering_mode_(bool park) {
+  this->engineering_parked_ = park;
+  // Not from within the frame handler: the commands block and frames are still being read
+  this->defer([this, park]() { this->set_engineering_mode(!park); });
+}
+#endif
+
+#ifdef USE_LD2412_STATS
+void LD2412Component::update_stats_(const PeriodicFrameView &frame) {
+  bool occupied = frame.has_target();
+  uint16_t active_gates = 0;
+  if (frame.is_engineering()) {
+    const GateVector threshold = GateVector::fill(this->stats_activity_threshold_);
+    active_gates = GateVector::load(frame.moving_energies()).at_least(threshold) |
+                   GateVector::load(frame.still_energies()).at_least(threshold);
+  } else if (occupied) {
+    // Without gate energies, the gate of the detection distance
+    uint16_t gate = frame.detection_distance() / this->gate_size_;
+    active_gates = 1U << std::min<uint16_t>(gate, TOTAL_GATES - 1);
+  }
+  this->stats_.add_frame(millis(), occupied, active_gates);
+}
+
+void LD2412Component::restore_stats_() {
+  bool restored = false;
+  for (uint8_t slot = 0; slot < STATS_SLOTS; slot++) {
+    this->stats_prefs_[slot] = global_preferences->make_preference<OccupancyData>(this->stats_key_ + slot, true);
+    OccupancyData data;
+    if (!this->stats_prefs_[slot].load(&data) || data.version != STATS_VERSION)
+      continue;
+    if (restored && int32_t(data.sequence - this->stats_.data().sequence) <= 0)
+      continue;
+    this->stats_.restore(data);
+    this->stats_next_slot_ = (slot + 1) % STATS_SLOTS;
+    restored = true;
+  }
+  if (restored) {
+    ESP_LOGI(TAG, "Statistics restored from checkpoint %u", (unsigned) this->stats_.data().sequence);
+  } else {
+    ESP_LOGI(TAG, "No statistics checkpoint, starting from zero");
+  }
+  this->stats_checkpoint_millis_ = millis();
+}
+
+/*
+  Checkpoints go to the slots in turn, so a write cut by a power loss leaves the previous
+  checkpoint intact. The preferences are written to flash at their next sync.
+*/
+void LD2412Component::checkpoint_stats_() {
+  if (!this->stats_.dirty())
+    return;
+  uint8_t slot = this->stats_next_slot_;
+  const OccupancyData &data = this->stats_.checkpoint();
+  if (this->stats_prefs_[slot].save(&data)) {
+    ESP_LOGD(TAG, "Statistics checkpoint %u in slot %u", (unsigned) data.sequence, slot);
+  } else {
+    ESP_LOGW(TAG, "Could not save statistics checkpoint %u", (unsigned) data.sequence);
+  }
+  this->stats_next_slot_ = (slot + 1) % STATS_SLOTS;
+  this->stats_checkpoint_millis_ = millis();
+}
+
+void LD2412Component::on_safe_shutdown() {
+  if (this->stats_key_ != 0)
+    this->checkpoint_stats_();
+}
+
+void LD2412Component::publish_stats_() {
+#ifdef USE_SENSOR
+  if (this->occupancy_last_hour_sensor_ != nullptr)
+    this->publish_changed_(this->occupancy_last_hour_sensor_, this->stats_.last_hour() / 60.0f, PUBLISH_DIAGNOSTIC);
+  if (this->occupancy_last_day_sensor_ != nullptr)
+    this->publish_changed_(this->occupancy_last_day_sensor_, this->stats_.last_day() / 60.0f, PUBLISH_DIAGNOSTIC);
+  if (this->occupancy_total_sensor_ != nullptr)
+    this->publish_changed_(this->occupancy_total_sensor_, this->stats_.data().occupied_seconds / 3600.0f,
+                           PUBLISH_DIAGNOSTIC);
+#endif
+}
+
+void LD2412Component::dump_stats() {
+  if (this->stats_key_ == 0)
+    return;
+  const OccupancyData &data = this->stats_.data();
+  float observed = data.observed_seconds > 0 ? data.observed_seconds : 1;
+  ESP_LOGI(TAG, "Occupancy statistics: checkpoint %u, observed %us, occupied %us (%.1f%%)", (unsigned) data.sequence,
+           (unsigned) data.observed_seconds, (unsigned) data.occupied_seconds, 100 * data.occupied_seconds / observed);
+  for (uint8_t i = 0; i < STATS_HOURS; i++) {
+    ESP_LOGI(TAG, "  hour -%u: %u min occupied", STATS_HOURS - 1 - i, this->stats_.hour_at(i) / 60);
+  }
+  for (uint8_t gate = 0; gate < STATS_GATES; gate++) {
+    ESP_LOGI(TAG, "  g%u: %us active (%.1f%%)", gate, (unsigned) data.gate_seconds[gate],
+             100 * data.gate_seconds[gate] / observed);
+  }
+}
+#endif
+
+void LD2412Component::apply_distance_resolution_(uint8_t resolution) {
+  uint8_t gate_size = gate_size_cm(resolution);
+  if (gate_size == this->gate_size_ && this->distance_resolution_applied_)
+    return;
+  this->gate_size_ = gate_size;
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+  // One gate of margin, the module can report a bit past the last gate
+  this->distance_calibration_.build((TOTAL_GATES + 1) * gate_size);
+#endif
+  this->distance_resolution_applied_ = true;
+#ifdef USE_TEXT_SENSOR
+  if (this->gate_ranges_text_sensor_ != nullptr) {
+    // "0-75,75-150,..." in cm, after calibration
+    std::string ranges;
+    char range[16];
+    for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+      snprintf(range, sizeof(range), "%s%u-%u", gate == 0 ? "" : ",", this->calibrate_distance_(gate * gate_size),
+               this->calibrate_distance_((gate + 1) * gate_size));
+      ranges += range;
+    }
+    this->gate_ranges_text_sensor_->publish_state(ranges);
+  }
+#endif
+}
+
+#ifdef USE_LD2412_WATCHDOG
+void LD2412Component::feed_watchdog_() {
+  this->watchdog_frame_millis_ = millis();
+  if (this->watchdog_stage_ == WATCHDOG_OK) {
+#ifdef USE_BINARY_SENSOR
+    if (this->online_binary_sensor_ != nullptr && !this->online_binary_sensor_->has_state())
+      this->online_binary_sensor_->publish_state(true);
+#endif
+    return;
+  }
+  this->watchdog_stage_ = WATCHDOG_OK;
+  this->watchdog_recoveries_++;
+  ESP_LOGI(TAG, "Module is sending frames again");
+#ifdef USE_SENSOR
+  if (this->recoveries_sensor_ != nullptr)
+    this->recoveries_sensor_->publish_state(this->watchdog_recoveries_);
+#endif
+  this->set_online_(true);
+}
+
+void LD2412Component::set_online_(bool online) {
+#ifdef USE_BINARY_SENSOR
+  if (this->online_binary_sensor_ != nullptr)
+    this->online_binary_sensor_->publish_state(online);
+#endif
+  if (online) {
+    // The frame that brought the module back publishes everything, even under the throttle
+    this->last_periodic_millis_ = millis() - this->throttle_;
+    return;
+  }
+  // Do not keep reporting the last target of a dead module
+#ifdef USE_BINARY_SENSOR
+  for (auto *s : {this->target_binary_sensor_, this->moving_target_binary_sensor_, this->still_target_binary_sensor_,
+                  this->out_pin_presence_status_binary_sensor_}) {
+    if (s != nullptr)
+      this->publish_(s, false, PUBLISH_PRESENCE);
+  }
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  if (!this->zone_binary_sensors_.empty())
+    this->clear_zone_occupancy_();
+#endif
+#endif
+#ifdef USE_SENSOR
+  for (auto *s : {this->moving_target_distance_sensor_, this->still_target_distance_sensor_,
+                  this->moving_target_energy_sensor_, this->still_target_energy_sensor_,
+                  this->detection_distance_sensor_}) {
+    if (s != nullptr)
+      this->publish_changed_(s, NAN, PUBLISH_DISTANCE);
+  }
+#endif
+}
+
+void LD2412Component::check_watchdog_() {
+  uint32_t now = millis();
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  // Background correction is reported through frames too, but can pause them while it runs
+  if (this->background_correction_.active()) {
+    this->watchdog_frame_millis_ = now;
+    return;
+  }
+#endif
+  if (now - this->watchdog_frame_millis_ < this->watchdog_timeout_)
+    return;
+  if (this->watchdog_stage_ != WATCHDOG_OK && now - this->watchdog_stage_millis_ < this->watchdog_timeout_)
+    return;
+
+  if (this->watchdog_stage_ == WATCHDOG_OK) {
+    ESP_LOGW(TAG, "No frame for %ums, module is offline", now - this->watchdog_frame_millis_);
+    this->set_online_(false);
+  }
+  switch (this->watchdog_stage_) {
+    case WATCHDOG_OK:
+    case WATCHDOG_POWER_CYCLE:
+      this->watchdog_stage_ = WATCHDOG_EXIT_CONFIG;
+      break;
+    case WATCHDOG_EXIT_CONFIG:
+      this->watchdog_stage_ = WATCHDOG_RESTART;
+      break;
+    case WATCHDOG_RESTART:
+      this->watchdog_stage_ = this->power_pin_ != nullptr ? WATCHDOG_POWER_CYCLE : WATCHDOG_EXIT_CONFIG;
+      break;
+  }
+  this->watchdog_stage_millis_ = now;
+  this->watchdog_restart_pending_ = false;
+  this->watchdog_attempts_[this->watchdog_stage_]++;
+#ifdef USE_SENSOR
+  if (this->recovery_attempts_sensor_ != nullptr) {
+    this->recovery_attempts_sensor_->publish_state(this->watchdog_attempts_[WATCHDOG_EXIT_CONFIG] +
+                                                   this->watchdog_attempts_[WATCHDOG_RESTART] +
+                                                   this->watchdog_attempts_[WATCHDOG_POWER_CYCLE]);
+  }
+#endif
+  switch (this->watchdog_stage_) {
+    case WATCHDOG_EXIT_CONFIG:
+      // Written directly: set_config_mode_ would reset the watchdog timer and block
+      ESP_LOGW(TAG, "Watchdog: leaving config mode");
+      this->write_command_(CMD_DISABLE_CONF, nullptr, 0);
+      break;
+    case WATCHDOG_RESTART: {
+      // The restart is written when the module acknowledges config mode
+      ESP_LOGW(TAG, "Watchdog: restarting the module");
+      uint8_t cmd_value[2] = {0x01, 0x00};
+      this->watchdog_restart_pending_ = true;
+      this->write_command_(CMD_ENABLE_CONF, cmd_value, 2);
+    } break;
+    case WATCHDOG_POWER_CYCLE:
+      ESP_LOGW(TAG, "Watchdog: power cycling the module");
+      this->power_pin_->digital_write(false);
+      this->set_timeout(this->power_off_time_, [this]() { this->power_pin_->digital_write(true); });
+      break;
+    default:
+      break;
+  }
+}
+#endif
+
+#ifdef USE_LD2412_GATE_SENSORS
+void LD2412Component::set_gate_move_sensor(int gate, sensor::Sensor *s) {
+  this->gate_move_sensors_.resize(TOTAL_GATES);
+  this->gate_move_sensors_[gate] = s;
+  this->gate_move_sensor_mask_ |= 1 << gate;
+}
+void LD2412Component::set_gate_still_sensor(int gate, sensor::Sensor *s) {
+  this->gate_still_sensors_.resize(TOTAL_GATES);
+  this->gate_still_sensors_[gate] = s;
+  this->gate_still_sensor_mask_ |= 1 << gate;
+}
+#endif
+
+#ifdef USE_LD2412_ZONE_ENERGY
+void LD2412Component::add_zone_energy_sensor(uint8_t start_gate, uint8_t end_gate, sensor::Sensor *s) {
+  if (this->zone_energy_sensors_.size() >= MAX_ZONES) {
+    ESP_LOGE(TAG, "Too many energy zones, max is %u", MAX_ZONES);
+    return;
+  }
+  uint16_t gates = 0;
+  for (uint8_t gate = start_gate; gate <= end_gate && gate < TOTAL_GATES; gate++) {
+    gates |= 1 << gate;
+  }
+  this->zone_energy_gates_.push_back(GateVector::from_mask(gates));
+  this->zone_energy_sensors_.push_back(s);
+}
+
+void LD2412Component::update_zone_energies_(const uint8_t *move_energies, const uint8_t *still_energies) {
+  const GateVector energies = GateVector::load(move_energies).max(GateVector::load(still_energies));
+  for (size_t zone = 0; zone < this->zone_energy_sensors_.size(); zone++) {
+    uint8_t energy = energies.masked(this->zone_energy_gates_[zone]).max_value();
+    this->publish_changed_(this->zone_energy_sensors_[zone], energy, PUBLISH_DIAGNOSTIC);
+  }
+}
+#endif
+
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+void LD2412Component::add_zone_binary_sensor(uint8_t start_gate, uint8_t end_gate, uint8_t move_threshold,
+                                             uint8_t still_threshold, binary_sensor::BinarySensor *s) {
+  if (this->zone_binary_sensors_.size() >= MAX_ZONES) {
+    ESP_LOGE(TAG, "Too many occupancy zones, max is %u", MAX_ZONES);
+    return;
+  }
+  if (this->zone_move_trip_.empty()) {
+    this->zone_move_trip_.resize(MAX_ENERGY + 1);
+    this->zone_still_trip_.resize(MAX_ENERGY + 1);
+  }
+  uint32_t zone_bit = 1UL << this->zone_binary_sensors_.size();
+  for (uint8_t gate = start_gate; gate <= end_gate && gate < TOTAL_GATES; gate++) {
+    this->gate_zone_mask_[gate] |= zone_bit;
+    this->zone_gates_ |= 1 << gate;
+  }
+  for (int energy = move_threshold; energy <= MAX_ENERGY; energy++) {
+    this->zone_move_trip_[energy] |= zone_bit;
+  }
+  for (int energy = still_threshold; energy <= MAX_ENERGY; energy++) {
+    this->zone_still_trip_[energy] |= zone_bit;
+  }
+  this->zone_min_move_threshold_ = GateVector::fill(std::min(this->zone_min_move_threshold_[0], move_threshold));
+  this->zone_min_still_threshold_ = GateVector::fill(std::min(this->zone_min_still_threshold_[0], still_threshold));
+  this->zone_binary_sensors_.push_back(s);
+}
+
+void LD2412Component::update_zone_occupancy_(const uint8_t *move_energies, const uint8_t *still_energies) {
+  // gates that can trip a zone, usually few
+  uint16_t gates = (GateVector::load(move_energies).at_least(this->zone_min_move_threshold_) |
+                    GateVector::load(still_energies).at_least(this->zone_min_still_threshold_)) &
+                   this->zone_gates_;
+  uint32_t occupied = 0;
+  for (; gates != 0; gates &= gates - 1) {
+    uint8_t gate = __builtin_ctz(gates);
+    uint8_t move = std::min(move_energies[gate], MAX_ENERGY);
+    uint8_t still = std::min(still_energies[gate], MAX_ENERGY);
+    occupied |= this->gate_zone_mask_[gate] & (this->zone_move_trip_[move] | this->zone_still_trip_[still]);
+  }
+  uint32_t changed = occupied ^ this->zone_occupied_;
+  if (!this->zone_occupancy_published_) {
+    changed = UINT32_MAX >> (MAX_ZONES - this->zone_binary_sensors_.size());
+    this->zone_occupancy_published_ = true;
+  }
+  this->zone_occupied_ = occupied;
+  while (changed != 0) {
+    uint8_t zone = __builtin_ctz(changed);
+    changed &= changed - 1;
+    this->publish_(this->zone_binary_sensors_[zone], CHECK_BIT(occupied, zone), PUBLISH_PRESENCE);
+  }
+}
+
+void LD2412Component::clear_zone_occupancy_() {
+  if (this->zone_occupancy_published_ && this->zone_occupied_ == 0)
+    return;
+  for (auto *s : this->zone_binary_sensors_) {
+    this->publish_(s, false, PUBLISH_PRESENCE);
+  }
+  this->zone_occupied_ = 0;
+  this->zone_occupancy_published_ = true;
+}
 #endif
 
 }  // namespace LD2412
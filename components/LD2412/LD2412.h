@@ -25,8 +25,48 @@
 #include "esphome/components/uart/uart.h"
 #include "esphome/core/automation.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/hal.h"
+#ifdef USE_LD2412_STATS
+#include "esphome/core/preferences.h"
+#endif
+#include "frame_history.h"
+#include "frame_views.h"
+#include "frame_parser.h"
+#ifdef USE_LD2412_CAPABILITIES
+#include "capabilities.h"
+#endif
+#ifdef USE_LD2412_RX_TASK
+#include "spsc_queue.h"
+#endif
+#include "frame_stream.h"
+#include "interference.h"
+#include "distance_calibration.h"
+#include "publish_scheduler.h"
+#include "gate_energies.h"
+#include "swar.h"
+#ifdef USE_LD2412_FRAME_TIMING
+#include "frame_timing.h"
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+#include "background_correction.h"
+#endif
+#include "trace.h"
+#include "occupancy_stats.h"
+#include "low_power.h"
+#include "command_stats.h"
+
+#include <memory>
+
+#ifdef USE_LD2412_RX_TASK
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
-#include <map>
+// Frames are only dated on arrival for the features reading that time
+#if defined(USE_LD2412_FRAME_TIMING) || defined(USE_LD2412_STREAM) || defined(USE_LD2412_TRACE) || \
+    defined(USE_LD2412_COMMAND_STATS)
+#define LD2412_FRAME_TIMESTAMPS
+#endif
 
 namespace esphome {
 namespace LD2412 {
@@ -72,7 +112,33 @@ enum BaudRateStructure : uint8_t {
   BAUD_RATE_460800 = 8
 };
 
-static const std::map<std::string, uint8_t> BAUD_RATE_ENUM_TO_INT{
+/*
+  Select options and their values in the protocol. Plain constant tables rather than maps:
+  nothing is built on the heap at boot, and a table no code uses is left out of the firmware.
+*/
+struct EnumOption {
+  const char *name;
+  uint8_t value;
+};
+// Value of an option not known yet
+static const uint8_t OPTION_UNKNOWN = 0xFF;
+
+template<size_t N> const EnumOption *find_option(const EnumOption (&options)[N], const std::string &name) {
+  for (const EnumOption &option : options) {
+    if (name == option.name)
+      return &option;
+  }
+  return nullptr;
+}
+template<size_t N> const char *option_name(const EnumOption (&options)[N], uint8_t value) {
+  for (const EnumOption &option : options) {
+    if (option.value == value)
+      return option.name;
+  }
+  return nullptr;
+}
+
+static const EnumOption BAUD_RATE_OPTIONS[] = {
     {"9600", BAUD_RATE_9600},     {"19200", BAUD_RATE_19200},   {"38400", BAUD_RATE_38400},
     {"57600", BAUD_RATE_57600},   {"115200", BAUD_RATE_115200}, {"230400", BAUD_RATE_230400},
     {"256000", BAUD_RATE_256000}, {"460800", BAUD_RATE_460800}};
@@ -83,76 +149,87 @@ enum ModeStructure : uint8_t {
   BACKGROUND_INIT_MODE = 3
 };
 
-static const std::map<std::string, uint8_t> MODE_ENUM_TO_INT{
+static const EnumOption MODE_OPTIONS[] = {
     {"Normal", NORMAL_MODE},{"Engineering", ENGINEERING_MODE},{"Dynamic background correction", BACKGROUND_INIT_MODE}
 };
 
 enum DistanceResolutionStructure : uint8_t { DISTANCE_RESOLUTION_0_2 = 0x03, DISTANCE_RESOLUTION_0_5 = 0x01, DISTANCE_RESOLUTION_0_75 = 0x00 };
 
-static const std::map<std::string, uint8_t> DISTANCE_RESOLUTION_ENUM_TO_INT{{"0.2m", DISTANCE_RESOLUTION_0_2},
-                                                                            {"0.5m", DISTANCE_RESOLUTION_0_5},
-                                                                            {"0.75m", DISTANCE_RESOLUTION_0_75}};
-static const std::map<uint8_t, std::string> DISTANCE_RESOLUTION_INT_TO_ENUM{{DISTANCE_RESOLUTION_0_2, "0.2m"},
-                                                                            {DISTANCE_RESOLUTION_0_5, "0.5m"},
-                                                                            {DISTANCE_RESOLUTION_0_75, "0.75m"}};
-
-// enum LightFunctionStructure : uint8_t {
-//   LIGHT_FUNCTION_OFF = 0x00,
-//   LIGHT_FUNCTION_BELOW = 0x01,
-//   LIGHT_FUNCTION_ABOVE = 0x02
-// };
-// 
-// static const std::map<std::string, uint8_t> LIGHT_FUNCTION_ENUM_TO_INT{
-//     {"off", LIGHT_FUNCTION_OFF}, {"below", LIGHT_FUNCTION_BELOW}, {"above", LIGHT_FUNCTION_ABOVE}};
-// static const std::map<uint8_t, std::string> LIGHT_FUNCTION_INT_TO_ENUM{
-//     {LIGHT_FUNCTION_OFF, "off"}, {LIGHT_FUNCTION_BELOW, "below"}, {LIGHT_FUNCTION_ABOVE, "above"}};
+static const EnumOption DISTANCE_RESOLUTION_OPTIONS[] = {
+    {"0.2m", DISTANCE_RESOLUTION_0_2}, {"0.5m", DISTANCE_RESOLUTION_0_5}, {"0.75m", DISTANCE_RESOLUTION_0_75}};
+
+enum LightFunctionStructure : uint8_t {
+  LIGHT_FUNCTION_OFF = 0x00,
+  LIGHT_FUNCTION_BELOW = 0x01,
+  LIGHT_FUNCTION_ABOVE = 0x02
+};
+
+static const EnumOption LIGHT_FUNCTION_OPTIONS[] = {
+    {"off", LIGHT_FUNCTION_OFF}, {"below", LIGHT_FUNCTION_BELOW}, {"above", LIGHT_FUNCTION_ABOVE}};
 
 enum OutPinLevelStructure : uint8_t { OUT_PIN_LEVEL_LOW = 0x01, OUT_PIN_LEVEL_HIGH = 0x00 };
 
-static const std::map<std::string, uint8_t> OUT_PIN_LEVEL_ENUM_TO_INT{{"low", OUT_PIN_LEVEL_LOW},
-                                                                      {"high", OUT_PIN_LEVEL_HIGH}};
-static const std::map<uint8_t, std::string> OUT_PIN_LEVEL_INT_TO_ENUM{{OUT_PIN_LEVEL_LOW, "low"},
-                                                                      {OUT_PIN_LEVEL_HIGH, "high"}};
+static const EnumOption OUT_PIN_LEVEL_OPTIONS[] = {{"low", OUT_PIN_LEVEL_LOW}, {"high", OUT_PIN_LEVEL_HIGH}};
 
 // Commands values
 static const uint8_t CMD_MAX_MOVE_VALUE = 0x0000;
 static const uint8_t CMD_MAX_STILL_VALUE = 0x0001;
 static const uint8_t CMD_DURATION_VALUE = 0x0002;
-// Command Header & Footer
-static const uint8_t CMD_FRAME_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
-static const uint8_t CMD_FRAME_END[4] = {0x04, 0x03, 0x02, 0x01};
-// Data Header & Footer
-static const uint8_t DATA_FRAME_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
-static const uint8_t DATA_FRAME_END[4] = {0xF8, 0xF7, 0xF6, 0xF5};
 
 static const char HEX_POSITIONING_CONVERSION[] = "0123456789ABCDEF"; 
 
 /*
-Data Type: 6th byte
-Target states: 9th byte
-    Moving target distance: 10~11th bytes
-    Moving target energy: 12th byte
-    Still target distance: 13~14th bytes
-    Still target energy: 15th byte
-    Detect distance: 16~17th bytes
+  How the UART is serviced:
+  - polling: every loop pass drains the UART
+  - frame_threshold: the UART is only checked once the next frame is due, and parsed once a
+    frame worth of bytes is buffered or the line went idle
+  - task (ESP32 only): a dedicated task assembles frames and hands them to the loop
+    through a lock-free queue, so loop stalls don't overrun the UART buffer
 */
-enum PeriodicDataStructure : uint8_t {
-  DATA_TYPES = 6,
-  TARGET_STATES = 8,
-  MOVING_TARGET_LOW = 9,
-  MOVING_TARGET_HIGH = 10,
-  MOVING_ENERGY = 11,
-  STILL_TARGET_LOW = 12,
-  STILL_TARGET_HIGH = 13,
-  STILL_ENERGY = 14,
-  MOVING_SENSOR_START = 17,
-  STILL_SENSOR_START = 31,
-  LIGHT_SENSOR = 45,
-  OUT_PIN_SENSOR = 38,
+enum RxMode : uint8_t { RX_MODE_POLLING = 0, RX_MODE_FRAME_THRESHOLD = 1, RX_MODE_TASK = 2 };
+
+#ifdef USE_LD2412_RX_TASK
+static const uint32_t RX_TASK_STACK_SIZE = 3072;
+static const UBaseType_t RX_TASK_PRIORITY = 5;
+// Time the RX task sleeps when the UART is empty, well below the time to fill the UART buffer
+static const TickType_t RX_TASK_IDLE_TICKS = pdMS_TO_TICKS(2);
+// Frames buffered between the RX task and the loop, about 1.5s of engineering frames
+static const size_t RX_QUEUE_SIZE = 16;
+
+struct RawFrame {
+  uint8_t len;
+#ifdef LD2412_FRAME_TIMESTAMPS
+  // micros() when the footer was read
+  uint32_t timestamp;
+#endif
+  uint8_t data[MAX_FRAME_LENGTH];
 };
-enum PeriodicDataValue : uint8_t { HEAD = 0XAA, END = 0x55, CHECK = 0x00 };
+#endif
 
-enum AckDataStructure : uint8_t { COMMAND = 6, COMMAND_STATUS = 7 };
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+// Time without new bytes after which buffered bytes are parsed even below the threshold
+static const uint32_t RX_IDLE_TIMEOUT = 2;
+#endif
+
+#ifdef USE_LD2412_WATCHDOG
+/*
+  Recovery steps taken by the watchdog when frames stop, each one is given a full
+  timeout to bring frames back before moving to the next. After the power cycle the
+  sequence starts over.
+*/
+enum WatchdogStage : uint8_t {
+  WATCHDOG_OK = 0,
+  WATCHDOG_EXIT_CONFIG = 1,
+  WATCHDOG_RESTART = 2,
+  WATCHDOG_POWER_CYCLE = 3,
+};
+static const uint32_t WATCHDOG_CHECK_INTERVAL = 250;
+#endif
+
+static const uint8_t TOTAL_GATES = 14;
+static const uint8_t MAX_ENERGY = 100;
+// Zones are tracked as bits of a uint32_t mask
+static const uint8_t MAX_ZONES = 32;
 
 //  char cmd[2] = {enable ? 0xFF : 0xFE, 0x00};
 class LD2412Component : public Component, public uart::UARTDevice {
@@ -163,16 +240,63 @@ class LD2412Component : public Component, public uart::UARTDevice {
   SUB_SENSOR(still_target_energy)
   SUB_SENSOR(light)
   SUB_SENSOR(detection_distance)
+#ifdef USE_LD2412_LOOP_STATS
+  SUB_SENSOR(loop_rate)
+  SUB_SENSOR(parser_time)
+  SUB_SENSOR(dropped_frames)
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  SUB_SENSOR(frame_jitter)
+  SUB_SENSOR(frame_interval)
+  SUB_SENSOR(frame_interval_min)
+  SUB_SENSOR(frame_interval_max)
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  SUB_SENSOR(spike_rate)
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  SUB_SENSOR(recovery_attempts)
+  SUB_SENSOR(recoveries)
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  SUB_SENSOR(deferred_publishes)
+  SUB_SENSOR(coalesced_publishes)
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  SUB_SENSOR(background_correction_progress)
+  SUB_SENSOR(background_correction_remaining)
+#endif
+#ifdef USE_LD2412_STATS
+  SUB_SENSOR(occupancy_last_hour)
+  SUB_SENSOR(occupancy_last_day)
+  SUB_SENSOR(occupancy_total)
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  SUB_SENSOR(wakeups)
+  SUB_SENSOR(awake_time)
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  SUB_SENSOR(command_latency)
+  SUB_SENSOR(command_latency_max)
+#endif
 #endif
 #ifdef USE_BINARY_SENSOR
   SUB_BINARY_SENSOR(target)
   SUB_BINARY_SENSOR(moving_target)
   SUB_BINARY_SENSOR(still_target)
   SUB_BINARY_SENSOR(out_pin_presence_status)
+#ifdef USE_LD2412_INTERFERENCE
+  SUB_BINARY_SENSOR(interference)
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  SUB_BINARY_SENSOR(online)
+#endif
 #endif
 #ifdef USE_TEXT_SENSOR
   SUB_TEXT_SENSOR(version)
   SUB_TEXT_SENSOR(mac)
+  SUB_TEXT_SENSOR(gate_ranges)
+  SUB_TEXT_SENSOR(gate_energies)
 #endif
 #ifdef USE_SELECT
   SUB_SELECT(distance_resolution)
@@ -213,11 +337,19 @@ class LD2412Component : public Component, public uart::UARTDevice {
 #if !defined(USE_NUMBER) && defined(USE_SELECT)
   void set_basic_config();
 #endif
-#ifdef USE_SENSOR
+#ifdef USE_LD2412_GATE_SENSORS
   void set_gate_move_sensor(int gate, sensor::Sensor *s);
   void set_gate_still_sensor(int gate, sensor::Sensor *s);
+#endif
+#ifdef USE_LD2412_ZONE_ENERGY
+  void add_zone_energy_sensor(uint8_t start_gate, uint8_t end_gate, sensor::Sensor *s);
+#endif
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  void add_zone_binary_sensor(uint8_t start_gate, uint8_t end_gate, uint8_t move_threshold, uint8_t still_threshold,
+                              binary_sensor::BinarySensor *s);
 #endif
   void set_throttle(uint16_t value) { this->throttle_ = value; };
+  void set_rx_mode(RxMode rx_mode) { this->rx_mode_ = rx_mode; }
   void set_bluetooth_password(const std::string &password);
   void set_engineering_mode(bool enable);
   void set_mode(const std::string &state);
@@ -227,21 +359,182 @@ class LD2412Component : public Component, public uart::UARTDevice {
   void set_distance_resolution(const std::string &state);
   void set_baud_rate(const std::string &state);
   void factory_reset();
+#ifdef USE_LD2412_STREAM
+  void set_stream(const std::string &host, uint16_t port, bool tcp, uint8_t batch_size, bool raw,
+                  uint32_t flush_interval) {
+    this->streamer_.set_host(host);
+    this->streamer_.set_port(port);
+    this->streamer_.set_tcp(tcp);
+    this->streamer_.set_batch_size(batch_size);
+    this->streamer_.set_raw(raw);
+    this->streamer_.set_flush_interval(flush_interval);
+  }
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  void set_interference_threshold(float events_per_second) { this->interference_.set_threshold(events_per_second); }
+#endif
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+  void set_distance_calibration(float scale, float offset) { this->distance_calibration_.set_linear(scale, offset); }
+  void add_distance_calibration_point(uint16_t raw, uint16_t actual) {
+    this->distance_calibration_.add_point(raw, actual);
+  }
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  void set_watchdog_timeout(uint32_t timeout) { this->watchdog_timeout_ = timeout; }
+  void set_power_pin(GPIOPin *power_pin) { this->power_pin_ = power_pin; }
+  void set_power_off_time(uint32_t power_off_time) { this->power_off_time_ = power_off_time; }
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  void set_publish_budget(uint16_t per_loop, uint16_t per_second) {
+    this->publish_scheduler_.set_loop_budget(per_loop);
+    this->publish_scheduler_.set_second_budget(per_second);
+  }
+#endif
+#ifdef USE_LD2412_HISTORY
+  void set_history_size(size_t size) { this->history_size_ = size; }
+  void dump_history();
+#endif
+#ifdef USE_LD2412_TRACE
+  void set_trace_size(size_t size) { this->trace_size_ = size; }
+  void dump_trace();
+#endif
+#ifdef USE_LD2412_STATS
+  // Checkpoints are stored under this key, the component id
+  void set_stats_key(const std::string &key) { this->stats_key_ = fnv1_hash("ld2412_stats_" + key); }
+  void set_stats_checkpoint_interval(uint32_t interval) { this->stats_checkpoint_interval_ = interval; }
+  void set_stats_activity_threshold(uint8_t threshold) { this->stats_activity_threshold_ = threshold; }
+  const OccupancyStats &get_stats() const { return this->stats_; }
+  void dump_stats();
+  void on_safe_shutdown() override;
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  const CommandStats &get_command_stats() const { return this->command_stats_; }
+  void dump_command_stats();
+#ifdef USE_SENSOR
+  void set_ack_error_sensor(AckError error, sensor::Sensor *s) { this->ack_error_sensors_[error] = s; }
+#endif
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  // Only the radars with low_power sleep, the others of the build keep the SoC awake
+  void set_low_power(bool low_power) { this->low_power_ = low_power; }
+  void set_low_power_guard(uint32_t guard) { this->sleep_planner_.set_guard(guard); }
+  void set_low_power_max_sleep(uint32_t max_sleep) { this->sleep_planner_.set_max_sleep(max_sleep); }
+  // GPIO wired to the OUT pin, wakes the SoC when presence changes
+  void set_wake_pin(InternalGPIOPin *wake_pin) { this->wake_pin_ = wake_pin; }
+  // 0 leaves engineering mode alone
+  void set_low_power_stable_time(uint32_t stable_time) { this->low_power_stable_time_ = stable_time; }
+  const SleepPlanner &get_sleep_planner() const { return this->sleep_planner_; }
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  const FrameTiming &get_frame_timing() const { return this->frame_timing_; }
+#endif
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  void set_background_correction_duration(uint32_t duration) {
+    this->background_correction_.set_expected_duration(duration);
+  }
+  const BackgroundCorrection &get_background_correction() const { return this->background_correction_; }
+  // Called with the duration in ms when the module reports the end of a background correction
+  void add_on_background_correction_callback(std::function<void(uint32_t)> &&callback) {
+    this->background_correction_callback_.add(std::move(callback));
+  }
+#endif
+#ifdef USE_LD2412_ON_FRAME
+  // Called with every valid periodic frame, before throttling
+  void add_on_frame_callback(std::function<void(const PeriodicFrameView &)> &&callback) {
+    this->frame_callback_.add(std::move(callback));
+  }
+#endif
 
  protected:
-  int two_byte_to_int_(char firstbyte, char secondbyte) { return (int16_t) (secondbyte << 8) + firstbyte; }
   void send_command_(uint8_t command_str, const uint8_t *command_value, int command_value_len);
+  // send_command_ without waiting, for sequences driven by their ACKs
+  void write_command_(uint8_t command_str, const uint8_t *command_value, int command_value_len);
   void set_config_mode_(bool enable);
   void handle_periodic_data_(uint8_t *buffer, int len);
-  bool handle_ack_data_(uint8_t *buffer, int len);
-  void readline_(int readch, uint8_t *buffer, int len);
+#ifdef USE_LD2412_CAPABILITIES
+  void handle_normalized_periodic_data_(uint8_t *buffer, int len);
+  void check_frame_layout_(int len);
+  void apply_capabilities_();
+  void reject_command_(uint8_t command);
+#endif
+  void handle_ack_data_(uint8_t *buffer, int len);
+  void handle_frame_(uint8_t *buffer, int len);
+  void receive_();
+  int readline_(int readch, uint8_t *buffer, int len);
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+  bool rx_ready_();
+  void track_frame_interval_(int len);
+#endif
+#ifdef USE_LD2412_RX_TASK
+  static void rx_task_(void *params);
+#endif
+#ifdef USE_SENSOR
+  void publish_loop_stats_();
+  // Frame driven publishes go through the publish budget when one is configured
+  void publish_(sensor::Sensor *s, float value, PublishPriority priority);
+  // Skips values equal to the current state
+  void publish_changed_(sensor::Sensor *s, float value, PublishPriority priority);
+#endif
+#ifdef USE_BINARY_SENSOR
+  void publish_(binary_sensor::BinarySensor *s, bool state, PublishPriority priority);
+#endif
   void query_parameters_();
   void get_version_();
   void get_mac_();
   void get_distance_resolution_();
   void get_light_control_();
   void restart_();
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
   void query_dymanic_background_correction_();
+  void start_background_correction_();
+  void update_background_correction_();
+  void handle_background_correction_ack_(bool active);
+  void end_background_correction_session_();
+  void finish_background_correction_(bool completed);
+  void publish_background_correction_();
+#endif
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  void update_zone_occupancy_(const uint8_t *move_energies, const uint8_t *still_energies);
+  void clear_zone_occupancy_();
+#endif
+#ifdef USE_LD2412_HISTORY
+  void record_frame_(const PeriodicFrameView &frame, bool throttled);
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  void update_interference_(const PeriodicFrameView &frame);
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  void light_sleep_();
+  void update_low_power_(const PeriodicFrameView &frame);
+  void park_engineering_mode_(bool park);
+#endif
+#ifdef USE_LD2412_STATS
+  void update_stats_(const PeriodicFrameView &frame);
+  void restore_stats_();
+  void checkpoint_stats_();
+  void publish_stats_();
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  void count_ack_error_(AckError error, uint8_t command);
+#else
+  void count_ack_error_(AckError error, uint8_t command) {}
+#endif
+  void apply_distance_resolution_(uint8_t resolution);
+  uint16_t calibrate_distance_(uint16_t raw) const {
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+    return this->distance_calibration_.apply(raw);
+#else
+    return raw;
+#endif
+  }
+#ifdef USE_LD2412_WATCHDOG
+  void check_watchdog_();
+  void feed_watchdog_();
+  void set_online_(bool online);
+#endif
+#ifdef USE_LD2412_ZONE_ENERGY
+  void update_zone_energies_(const uint8_t *move_energies, const uint8_t *still_energies);
+#endif
 
   std::string format_buffer(uint8_t* buffer, size_t len)
   {
@@ -255,22 +548,174 @@ class LD2412Component : public Component, public uart::UARTDevice {
     return version;
   }
 
+  uint8_t rx_buffer_[MAX_FRAME_LENGTH];
+  FrameParser rx_parser_;
+#ifdef LD2412_FRAME_TIMESTAMPS
+  // arrival of the footer of the frame returned by readline_, in us
+  uint32_t rx_frame_timestamp_{0};
+  // time of one byte on the wire in us, to date the footer before the bytes still buffered after it
+  uint32_t rx_byte_micros_{0};
+  // timestamp of the frame being decoded
+  uint32_t frame_timestamp_{0};
+#endif
+#ifdef USE_LD2412_FRAME_TIMING
+  FrameTiming frame_timing_;
+#endif
+  RxMode rx_mode_{RX_MODE_POLLING};
+#ifdef USE_LD2412_RX_FRAME_THRESHOLD
+  // frame_threshold mode state
+  uint32_t rx_next_check_millis_{0};
+  uint32_t rx_pending_since_millis_{0};
+  int rx_pending_{0};
+  int rx_threshold_{NORMAL_FRAME_SIZE};
+  uint32_t last_frame_millis_{0};
+  // smoothed interval between periodic frames, 0 until known
+  uint32_t frame_interval_{0};
+#endif
+#ifdef USE_SENSOR
+  uint32_t loop_stats_millis_{0};
+#endif
+#ifdef USE_LD2412_LOOP_STATS
+  // loop statistics, reset every second
+  uint32_t loop_count_{0};
+  uint32_t parser_micros_{0};
+  // frames lost because the RX task queue was full
+  uint32_t dropped_frames_{0};
+#endif
+#ifdef USE_LD2412_RX_TASK
+  SPSCQueue<RawFrame, RX_QUEUE_SIZE> rx_queue_;
+  TaskHandle_t rx_task_handle_{nullptr};
+#endif
   int32_t last_periodic_millis_ = millis();
   int32_t last_engineering_mode_change_millis_ = millis();
   uint16_t throttle_;
   std::string version_;
   std::string mac_;
-  std::string out_pin_level_;
-  bool dynamic_bakground_correction_active_;
-  std::string light_function_;
+  // OUT_PIN_LEVEL_* and LIGHT_FUNCTION_*, OPTION_UNKNOWN until read from the module
+  uint8_t out_pin_level_{OPTION_UNKNOWN};
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+  BackgroundCorrection background_correction_;
+  CallbackManager<void(uint32_t)> background_correction_callback_;
+#endif
+  uint8_t light_function_{OPTION_UNKNOWN};
   float light_threshold_ = -1;
 #ifdef USE_NUMBER
   std::vector<number::Number *> gate_still_threshold_numbers_ = std::vector<number::Number *>(14);
   std::vector<number::Number *> gate_move_threshold_numbers_ = std::vector<number::Number *>(14);
 #endif
+#ifdef USE_LD2412_GATE_SENSORS
+  // sized when the first gate sensor is set
+  std::vector<sensor::Sensor *> gate_still_sensors_;
+  std::vector<sensor::Sensor *> gate_move_sensors_;
+  // gates with a sensor, and their energies when last published
+  uint16_t gate_move_sensor_mask_{0};
+  uint16_t gate_still_sensor_mask_{0};
+  GateVector last_moving_energies_;
+  GateVector last_still_energies_;
+  bool gate_energies_published_{false};
+#endif
+#ifdef USE_LD2412_ZONE_ENERGY
+  /*
+    Zone energy: the gates outside the zone are masked out of the gate by gate maximum of
+    the moving and still energies, the zone energy is the highest byte left.
+  */
+  std::vector<sensor::Sensor *> zone_energy_sensors_;
+  // 0xFF in the bytes of the gates of each zone
+  std::vector<GateVector> zone_energy_gates_;
+#endif
+#ifdef USE_LD2412_ZONE_OCCUPANCY
+  /*
+    Zone occupancy: gate_zone_mask_[gate] holds the zones covering the gate,
+    zone_*_trip_[energy] holds the zones whose threshold is reached by that energy.
+    A zone is occupied if any of its gates trips it. All gates are first compared at once
+    against the lowest thresholds, only the gates reaching them are looked up.
+  */
+  std::vector<binary_sensor::BinarySensor *> zone_binary_sensors_;
+  std::vector<uint32_t> zone_move_trip_;
+  std::vector<uint32_t> zone_still_trip_;
+  uint32_t gate_zone_mask_[TOTAL_GATES]{};
+  // gates covered by any zone
+  uint16_t zone_gates_{0};
+  GateVector zone_min_move_threshold_ = GateVector::fill(UINT8_MAX);
+  GateVector zone_min_still_threshold_ = GateVector::fill(UINT8_MAX);
+  uint32_t zone_occupied_{0};
+  bool zone_occupancy_published_{false};
+#endif
+#ifdef USE_LD2412_STREAM
+  FrameStreamer streamer_;
+#endif
+#ifdef USE_LD2412_ON_FRAME
+  CallbackManager<void(const PeriodicFrameView &)> frame_callback_;
+#endif
+#ifdef USE_LD2412_HISTORY
+  FrameHistory history_;
+  size_t history_size_{0};
+#endif
+#ifdef USE_LD2412_INTERFERENCE
+  InterferenceDetector interference_;
+#endif
+#ifdef USE_LD2412_PUBLISH_BUDGET
+  PublishScheduler publish_scheduler_;
+#endif
+#ifdef USE_LD2412_TRACE
+  TraceRing trace_;
+  size_t trace_size_{0};
+#endif
+#ifdef USE_LD2412_STATS
+  OccupancyStats stats_;
+  ESPPreferenceObject stats_prefs_[STATS_SLOTS];
+  uint32_t stats_key_{0};
+  uint8_t stats_next_slot_{0};
+  uint32_t stats_checkpoint_interval_{3600000};
+  uint32_t stats_checkpoint_millis_{0};
+  uint8_t stats_activity_threshold_{40};
+#endif
+#ifdef USE_LD2412_COMMAND_STATS
+  CommandStats command_stats_;
+  // command frames dropped by readline_, and those already counted as ACK errors
+  uint32_t rx_bad_acks_{0};
+  uint32_t rx_bad_acks_counted_{0};
 #ifdef USE_SENSOR
-  std::vector<sensor::Sensor *> gate_still_sensors_ = std::vector<sensor::Sensor *>(14);
-  std::vector<sensor::Sensor *> gate_move_sensors_ = std::vector<sensor::Sensor *>(14);
+  sensor::Sensor *ack_error_sensors_[ACK_ERROR_TYPES]{};
+#endif
+#endif
+#ifdef USE_LD2412_LOW_POWER
+  bool low_power_{false};
+  SleepPlanner sleep_planner_;
+  InternalGPIOPin *wake_pin_{nullptr};
+  uint32_t low_power_stable_time_{0};
+  // last target state and when it changed
+  bool low_power_target_{false};
+  uint32_t low_power_target_millis_{0};
+  // engineering mode turned off by the low power mode, to be turned back on
+  bool engineering_parked_{false};
+#endif
+#ifdef USE_LD2412_CAPABILITIES
+  Capabilities capabilities_;
+  // Chosen by apply_capabilities_: frames in the 14 gates layout are decoded in place, others are copied first
+  void (LD2412Component::*handle_periodic_)(uint8_t *buffer, int len){&LD2412Component::handle_periodic_data_};
+  // allocated by apply_capabilities_ once a frame outside the 14 gates layout is seen
+  std::unique_ptr<uint8_t[]> normalized_frame_;
+#endif
+  uint8_t gate_size_{DEFAULT_GATE_SIZE_CM};
+  bool distance_resolution_applied_{false};
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+  DistanceCalibration distance_calibration_;
+#endif
+#ifdef USE_LD2412_WATCHDOG
+  // time of the last valid periodic frame, or of the end of our own config mode session
+  uint32_t watchdog_frame_millis_{0};
+  uint32_t watchdog_stage_millis_{0};
+  // 0 when this radar has no watchdog, other radars of the build may have one
+  uint32_t watchdog_timeout_{0};
+  WatchdogStage watchdog_stage_{WATCHDOG_OK};
+  // WATCHDOG_RESTART waits for the config mode ACK before writing the restart
+  bool watchdog_restart_pending_{false};
+  GPIOPin *power_pin_{nullptr};
+  uint32_t power_off_time_{1000};
+  // attempts per stage, index 0 unused
+  uint32_t watchdog_attempts_[4]{};
+  uint32_t watchdog_recoveries_{0};
 #endif
 };
 
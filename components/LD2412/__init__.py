@@ -1,11 +1,34 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import uart
-from esphome.const import CONF_ID, CONF_THROTTLE, CONF_TIMEOUT, CONF_PASSWORD
-from esphome import automation
+from esphome.const import (
+    CONF_ID,
+    CONF_THROTTLE,
+    CONF_TIMEOUT,
+    CONF_PASSWORD,
+    CONF_SIZE,
+    CONF_HOST,
+    CONF_PORT,
+    CONF_PROTOCOL,
+    CONF_TRIGGER_ID,
+)
+from esphome import automation, pins
 from esphome.automation import maybe_simple_id
+from esphome.core import CORE, EsphomeError
 
 DEPENDENCIES = ["uart"]
+
+
+def AUTO_LOAD():
+    # sockets are only built for the frame stream
+    configs = CORE.raw_config.get("LD2412") or []
+    if isinstance(configs, dict):
+        configs = [configs]
+    if any(CONF_STREAM in conf for conf in configs if isinstance(conf, dict)):
+        return ["socket"]
+    return []
+
+
 CODEOWNERS = ["@sebcaps", "@regevbr"]
 MULTI_CONF = True
 
@@ -19,6 +42,118 @@ CONF_MAX_STILL_DISTANCE = "max_still_distance"
 CONF_STILL_THRESHOLDS = [f"g{x}_still_threshold" for x in range(9)]
 CONF_MOVE_THRESHOLDS = [f"g{x}_move_threshold" for x in range(9)]
 
+CONF_HISTORY = "history"
+CONF_TRACE = "trace"
+CONF_STATS = "stats"
+CONF_CHECKPOINT_INTERVAL = "checkpoint_interval"
+CONF_ACTIVITY_THRESHOLD = "activity_threshold"
+CONF_GATE_ENERGIES = "gate_energies"
+
+CONF_RX_MODE = "rx_mode"
+CONF_FIRMWARE_CAPABILITIES = "firmware_capabilities"
+
+CONF_ON_FRAME = "on_frame"
+CONF_EVERY = "every"
+PeriodicFrameView = LD2412_ns.class_("PeriodicFrameView")
+PeriodicFrameViewConstRef = PeriodicFrameView.operator("ref").operator("const")
+FrameTrigger = LD2412_ns.class_(
+    "FrameTrigger", automation.Trigger.template(PeriodicFrameViewConstRef)
+)
+
+CONF_BACKGROUND_CORRECTION_DURATION = "background_correction_duration"
+CONF_ON_BACKGROUND_CORRECTION_COMPLETE = "on_background_correction_complete"
+BackgroundCorrectionTrigger = LD2412_ns.class_(
+    "BackgroundCorrectionTrigger", automation.Trigger.template(cg.uint32)
+)
+
+CONF_COMMAND_STATS = "command_stats"
+AckError = LD2412_ns.enum("AckError")
+
+RxMode = LD2412_ns.enum("RxMode")
+RX_MODES = {
+    "polling": RxMode.RX_MODE_POLLING,
+    "frame_threshold": RxMode.RX_MODE_FRAME_THRESHOLD,
+    "task": RxMode.RX_MODE_TASK,
+}
+
+
+def validate_rx_mode(config):
+    if config[CONF_RX_MODE] == "task" and not CORE.is_esp32:
+        raise cv.Invalid(f"'{CONF_RX_MODE}: task' is only available on ESP32")
+    return config
+
+
+def validate_low_power(config):
+    if CONF_LOW_POWER not in config:
+        return config
+    if not CORE.is_esp32:
+        raise cv.Invalid(f"'{CONF_LOW_POWER}' is only available on ESP32")
+    if config[CONF_RX_MODE] == "task":
+        # the task cannot read the UART while the SoC sleeps
+        raise cv.Invalid(f"'{CONF_LOW_POWER}' cannot be used with '{CONF_RX_MODE}: task'")
+    return config
+
+
+CONF_STREAM = "stream"
+CONF_BATCH_SIZE = "batch_size"
+CONF_RAW = "raw"
+CONF_FLUSH_INTERVAL = "flush_interval"
+
+STREAM_PROTOCOLS = {"udp": False, "tcp": True}
+
+CONF_WATCHDOG = "watchdog"
+CONF_FRAME_INTERVAL = "frame_interval"
+CONF_MISSED_FRAMES = "missed_frames"
+CONF_POWER_PIN = "power_pin"
+CONF_POWER_OFF_TIME = "power_off_time"
+
+CONF_LOW_POWER = "low_power"
+CONF_GUARD = "guard"
+CONF_MAX_SLEEP = "max_sleep"
+CONF_WAKE_PIN = "wake_pin"
+CONF_STABLE_TIME = "stable_time"
+
+CONF_PUBLISH_BUDGET = "publish_budget"
+CONF_PER_LOOP = "per_loop"
+CONF_PER_SECOND = "per_second"
+
+CONF_DISTANCE_CALIBRATION = "distance_calibration"
+CONF_SCALE = "scale"
+CONF_OFFSET = "offset"
+CONF_POINTS = "points"
+CONF_RAW_DISTANCE = "raw"
+CONF_ACTUAL_DISTANCE = "actual"
+
+
+def validate_calibration_points(points):
+    raws = [point[CONF_RAW_DISTANCE] for point in points]
+    if raws != sorted(set(raws)):
+        raise cv.Invalid("Calibration points must have strictly increasing raw distances")
+    return points
+
+
+def validate_calibration(config):
+    if CONF_POINTS in config and (CONF_SCALE in config or CONF_OFFSET in config):
+        raise cv.Invalid(
+            f"'{CONF_POINTS}' cannot be combined with '{CONF_SCALE}' or '{CONF_OFFSET}'"
+        )
+    return config
+
+
+CONF_ZONES = "zones"
+CONF_START_GATE = "start_gate"
+CONF_END_GATE = "end_gate"
+
+MAX_ZONES = 32
+
+
+def validate_zone_gates(config):
+    if config[CONF_START_GATE] > config[CONF_END_GATE]:
+        raise cv.Invalid(
+            f"'{CONF_START_GATE}' must be lower than or equal to '{CONF_END_GATE}'"
+        )
+    return config
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(LD2412Component),
@@ -26,6 +161,131 @@ CONFIG_SCHEMA = cv.Schema(
             cv.positive_time_period_milliseconds,
             cv.Range(min=cv.TimePeriod(milliseconds=1)),
         ),
+        cv.Optional(CONF_RX_MODE, default="polling"): cv.enum(RX_MODES, lower=True),
+        # gates and commands from the firmware version, off for a module known to match
+        cv.Optional(CONF_FIRMWARE_CAPABILITIES, default=True): cv.boolean,
+        # command round trip histograms and ACK error counters, for LD2412.dump_command_stats
+        cv.Optional(CONF_COMMAND_STATS, default=False): cv.boolean,
+        cv.Optional(CONF_ON_FRAME): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(FrameTrigger),
+                # run on one frame out of every
+                cv.Optional(CONF_EVERY, default=1): cv.int_range(min=1, max=10000),
+            }
+        ),
+        # first estimate of the background correction time (120s if not set),
+        # then the last measured one
+        cv.Optional(CONF_BACKGROUND_CORRECTION_DURATION): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(seconds=1)),
+        ),
+        cv.Optional(CONF_ON_BACKGROUND_CORRECTION_COMPLETE): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(
+                    BackgroundCorrectionTrigger
+                ),
+            }
+        ),
+        cv.Optional(CONF_HISTORY): cv.Schema(
+            {
+                cv.Optional(CONF_SIZE, default=200): cv.int_range(min=1, max=4096),
+                cv.Optional(CONF_GATE_ENERGIES, default=False): cv.boolean,
+            }
+        ),
+        cv.Optional(CONF_TRACE): cv.Schema(
+            {
+                # rounded up to a power of two, 8 bytes each
+                cv.Optional(CONF_SIZE, default=512): cv.int_range(min=16, max=8192),
+            }
+        ),
+        cv.Optional(CONF_STATS): cv.Schema(
+            {
+                # bounds the flash writes (24 a day at 1h), changes in between coalesce
+                cv.Optional(CONF_CHECKPOINT_INTERVAL, default="1h"): cv.All(
+                    cv.positive_time_period_milliseconds,
+                    cv.Range(min=cv.TimePeriod(minutes=1)),
+                ),
+                cv.Optional(CONF_ACTIVITY_THRESHOLD, default=40): cv.int_range(
+                    min=0, max=100
+                ),
+            }
+        ),
+        cv.Optional(CONF_STREAM): cv.Schema(
+            {
+                cv.Required(CONF_HOST): cv.ipv4address,
+                cv.Required(CONF_PORT): cv.port,
+                cv.Optional(CONF_PROTOCOL, default="udp"): cv.enum(
+                    STREAM_PROTOCOLS, lower=True
+                ),
+                cv.Optional(CONF_BATCH_SIZE, default=8): cv.int_range(min=1, max=32),
+                cv.Optional(CONF_RAW, default=False): cv.boolean,
+                # a partial batch is sent after this long, frames do not wait for a full one
+                cv.Optional(CONF_FLUSH_INTERVAL, default="1s"): cv.All(
+                    cv.positive_time_period_milliseconds,
+                    cv.Range(min=cv.TimePeriod(milliseconds=10)),
+                ),
+            }
+        ),
+        cv.Optional(CONF_PUBLISH_BUDGET): cv.Schema(
+            {
+                cv.Optional(CONF_PER_LOOP, default=8): cv.int_range(min=1, max=255),
+                # 0: no per second limit
+                cv.Optional(CONF_PER_SECOND, default=0): cv.int_range(min=0, max=1000),
+            }
+        ),
+        cv.Optional(CONF_DISTANCE_CALIBRATION): cv.All(
+            cv.Schema(
+                {
+                    cv.Optional(CONF_SCALE): cv.positive_float,
+                    # in cm, added after scaling
+                    cv.Optional(CONF_OFFSET): cv.int_range(min=-500, max=500),
+                    # measured distances in cm, replace scale and offset
+                    cv.Optional(CONF_POINTS): cv.All(
+                        cv.ensure_list(
+                            cv.Schema(
+                                {
+                                    cv.Required(CONF_RAW_DISTANCE): cv.int_range(min=0, max=2000),
+                                    cv.Required(CONF_ACTUAL_DISTANCE): cv.int_range(min=0, max=2000),
+                                }
+                            )
+                        ),
+                        cv.Length(min=2),
+                        validate_calibration_points,
+                    ),
+                }
+            ),
+            validate_calibration,
+        ),
+        cv.Optional(CONF_WATCHDOG): cv.Schema(
+            {
+                # expected time between two frames, about 50ms in engineering mode and 100ms otherwise
+                cv.Optional(
+                    CONF_FRAME_INTERVAL, default="100ms"
+                ): cv.positive_time_period_milliseconds,
+                cv.Optional(CONF_MISSED_FRAMES, default=20): cv.int_range(min=2, max=1000),
+                cv.Optional(CONF_POWER_PIN): pins.gpio_output_pin_schema,
+                cv.Optional(
+                    CONF_POWER_OFF_TIME, default="1s"
+                ): cv.positive_time_period_milliseconds,
+            }
+        ),
+        cv.Optional(CONF_LOW_POWER): cv.Schema(
+            {
+                # the sleep ends this long before the next expected frame
+                cv.Optional(CONF_GUARD, default="3ms"): cv.All(
+                    cv.positive_time_period_microseconds,
+                    cv.Range(min=cv.TimePeriod(microseconds=500)),
+                ),
+                # longest time other components wait for the loop
+                cv.Optional(CONF_MAX_SLEEP, default="1s"): cv.All(
+                    cv.positive_time_period_microseconds,
+                    cv.Range(min=cv.TimePeriod(milliseconds=10)),
+                ),
+                cv.Optional(CONF_WAKE_PIN): pins.internal_gpio_input_pin_schema,
+                # engineering mode is turned off while the target state is stable this long
+                cv.Optional(CONF_STABLE_TIME): cv.positive_time_period_milliseconds,
+            }
+        ),
         cv.Optional(CONF_MAX_MOVE_DISTANCE): cv.invalid(
             f"The '{CONF_MAX_MOVE_DISTANCE}' option has been moved to the '{CONF_MAX_MOVE_DISTANCE}'"
             f" number component"
@@ -58,7 +318,9 @@ for i in range(9):
     )
 
 CONFIG_SCHEMA = cv.All(
-    CONFIG_SCHEMA.extend(uart.UART_DEVICE_SCHEMA).extend(cv.COMPONENT_SCHEMA)
+    CONFIG_SCHEMA.extend(uart.UART_DEVICE_SCHEMA).extend(cv.COMPONENT_SCHEMA),
+    validate_rx_mode,
+    validate_low_power,
 )
 
 FINAL_VALIDATE_SCHEMA = uart.final_validate_device_schema(
@@ -75,6 +337,104 @@ async def to_code(config):
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
     cg.add(var.set_throttle(config[CONF_THROTTLE]))
+    cg.add(var.set_rx_mode(config[CONF_RX_MODE]))
+    if config[CONF_RX_MODE] == "task":
+        cg.add_define("USE_LD2412_RX_TASK")
+    if config[CONF_RX_MODE] == "frame_threshold":
+        cg.add_define("USE_LD2412_RX_FRAME_THRESHOLD")
+    if config[CONF_FIRMWARE_CAPABILITIES]:
+        cg.add_define("USE_LD2412_CAPABILITIES")
+    if config[CONF_COMMAND_STATS]:
+        cg.add_define("USE_LD2412_COMMAND_STATS")
+    for conf in config.get(CONF_ON_FRAME, []):
+        # the view carries the frame interval
+        cg.add_define("USE_LD2412_ON_FRAME")
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var, conf[CONF_EVERY])
+        await automation.build_automation(
+            trigger, [(PeriodicFrameViewConstRef, "frame")], conf
+        )
+    if background_correction_duration := config.get(
+        CONF_BACKGROUND_CORRECTION_DURATION
+    ):
+        cg.add_define("USE_LD2412_BACKGROUND_CORRECTION")
+        cg.add(var.set_background_correction_duration(background_correction_duration))
+    for conf in config.get(CONF_ON_BACKGROUND_CORRECTION_COMPLETE, []):
+        cg.add_define("USE_LD2412_BACKGROUND_CORRECTION")
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.uint32, "duration")], conf)
+    if history_config := config.get(CONF_HISTORY):
+        cg.add_define("USE_LD2412_HISTORY")
+        if history_config[CONF_GATE_ENERGIES]:
+            cg.add_define("USE_LD2412_HISTORY_GATES")
+        cg.add(var.set_history_size(history_config[CONF_SIZE]))
+    if trace_config := config.get(CONF_TRACE):
+        cg.add_define("USE_LD2412_TRACE")
+        cg.add(var.set_trace_size(trace_config[CONF_SIZE]))
+    if stats_config := config.get(CONF_STATS):
+        cg.add_define("USE_LD2412_STATS")
+        cg.add(var.set_stats_key(str(config[CONF_ID])))
+        cg.add(
+            var.set_stats_checkpoint_interval(stats_config[CONF_CHECKPOINT_INTERVAL])
+        )
+        cg.add(var.set_stats_activity_threshold(stats_config[CONF_ACTIVITY_THRESHOLD]))
+    if stream_config := config.get(CONF_STREAM):
+        cg.add_define("USE_LD2412_STREAM")
+        cg.add(
+            var.set_stream(
+                str(stream_config[CONF_HOST]),
+                stream_config[CONF_PORT],
+                stream_config[CONF_PROTOCOL],
+                stream_config[CONF_BATCH_SIZE],
+                stream_config[CONF_RAW],
+                stream_config[CONF_FLUSH_INTERVAL],
+            )
+        )
+    if budget_config := config.get(CONF_PUBLISH_BUDGET):
+        cg.add_define("USE_LD2412_PUBLISH_BUDGET")
+        cg.add(
+            var.set_publish_budget(
+                budget_config[CONF_PER_LOOP], budget_config[CONF_PER_SECOND]
+            )
+        )
+    if calibration_config := config.get(CONF_DISTANCE_CALIBRATION):
+        cg.add_define("USE_LD2412_DISTANCE_CALIBRATION")
+        cg.add(
+            var.set_distance_calibration(
+                calibration_config.get(CONF_SCALE, 1.0),
+                calibration_config.get(CONF_OFFSET, 0),
+            )
+        )
+        for point in calibration_config.get(CONF_POINTS, []):
+            cg.add(
+                var.add_distance_calibration_point(
+                    point[CONF_RAW_DISTANCE], point[CONF_ACTUAL_DISTANCE]
+                )
+            )
+    if watchdog_config := config.get(CONF_WATCHDOG):
+        cg.add_define("USE_LD2412_WATCHDOG")
+        cg.add(
+            var.set_watchdog_timeout(
+                watchdog_config[CONF_FRAME_INTERVAL].total_milliseconds
+                * watchdog_config[CONF_MISSED_FRAMES]
+            )
+        )
+        if power_pin_config := watchdog_config.get(CONF_POWER_PIN):
+            power_pin = await cg.gpio_pin_expression(power_pin_config)
+            cg.add(var.set_power_pin(power_pin))
+        cg.add(var.set_power_off_time(watchdog_config[CONF_POWER_OFF_TIME]))
+    if low_power_config := config.get(CONF_LOW_POWER):
+        cg.add_define("USE_LD2412_LOW_POWER")
+        # sleeps are planned from the frame timing
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        cg.add(var.set_low_power(True))
+        cg.add(var.set_low_power_guard(low_power_config[CONF_GUARD]))
+        cg.add(var.set_low_power_max_sleep(low_power_config[CONF_MAX_SLEEP]))
+        if wake_pin_config := low_power_config.get(CONF_WAKE_PIN):
+            wake_pin = await cg.gpio_pin_expression(wake_pin_config)
+            cg.add(var.set_wake_pin(wake_pin))
+        if stable_time := low_power_config.get(CONF_STABLE_TIME):
+            cg.add(var.set_low_power_stable_time(stable_time))
 
 
 CALIBRATION_ACTION_SCHEMA = maybe_simple_id(
@@ -88,6 +448,33 @@ CALIBRATION_ACTION_SCHEMA = maybe_simple_id(
 BluetoothPasswordSetAction = LD2412_ns.class_(
     "BluetoothPasswordSetAction", automation.Action
 )
+DumpHistoryAction = LD2412_ns.class_("DumpHistoryAction", automation.Action)
+DumpTraceAction = LD2412_ns.class_("DumpTraceAction", automation.Action)
+DumpStatsAction = LD2412_ns.class_("DumpStatsAction", automation.Action)
+DumpCommandStatsAction = LD2412_ns.class_("DumpCommandStatsAction", automation.Action)
+
+DUMP_ACTION_SCHEMA = maybe_simple_id(
+    {
+        cv.Required(CONF_ID): cv.use_id(LD2412Component),
+    }
+)
+
+
+def hub_config(hub_id):
+    """Configuration of the LD2412 an action refers to"""
+    return next(conf for conf in CORE.config["LD2412"] if conf[CONF_ID].id == hub_id.id)
+
+
+def require_hub_option(user, hub_id, option):
+    """Fails the build when an action or entity needs a feature its hub does not configure.
+
+    Features run per hub, configuring one hub must not start them on the others.
+    Boolean options with a default are always present, they must be true.
+    """
+    if hub_config(hub_id).get(option) in (None, False):
+        raise EsphomeError(
+            f"'{user}' needs '{option}:' in the configuration of LD2412 '{hub_id.id}'"
+        )
 
 
 BLUETOOTH_PASSWORD_SET_SCHEMA = cv.Schema(
@@ -107,3 +494,41 @@ async def bluetooth_password_set_to_code(config, action_id, template_arg, args):
     template_ = await cg.templatable(config[CONF_PASSWORD], args, cg.std_string)
     cg.add(var.set_password(template_))
     return var
+
+
+@automation.register_action(
+    "LD2412.dump_history", DumpHistoryAction, DUMP_ACTION_SCHEMA
+)
+async def dump_history_to_code(config, action_id, template_arg, args):
+    require_hub_option("LD2412.dump_history", config[CONF_ID], CONF_HISTORY)
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
+
+
+@automation.register_action(
+    "LD2412.dump_trace", DumpTraceAction, DUMP_ACTION_SCHEMA
+)
+async def dump_trace_to_code(config, action_id, template_arg, args):
+    require_hub_option("LD2412.dump_trace", config[CONF_ID], CONF_TRACE)
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
+
+
+@automation.register_action(
+    "LD2412.dump_stats", DumpStatsAction, DUMP_ACTION_SCHEMA
+)
+async def dump_stats_to_code(config, action_id, template_arg, args):
+    require_hub_option("LD2412.dump_stats", config[CONF_ID], CONF_STATS)
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
+
+
+@automation.register_action(
+    "LD2412.dump_command_stats", DumpCommandStatsAction, DUMP_ACTION_SCHEMA
+)
+async def dump_command_stats_to_code(config, action_id, template_arg, args):
+    require_hub_option(
+        "LD2412.dump_command_stats", config[CONF_ID], CONF_COMMAND_STATS
+    )
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
@@ -18,5 +18,86 @@ template<typename... Ts> class BluetoothPasswordSetAction : public Action<Ts...>
   LD2412Component *LD2412_comp_;
 };
 
+#ifdef USE_LD2412_ON_FRAME
+/*
+  on_frame: runs with the view of every valid periodic frame (or of one frame out of every),
+  before throttling. The view points into the receive buffer and is only valid while the
+  automation runs synchronously, values needed after a delay must be copied out first.
+*/
+class FrameTrigger : public Trigger<const PeriodicFrameView &> {
+ public:
+  FrameTrigger(LD2412Component *parent, uint32_t every) : every_(every) {
+    parent->add_on_frame_callback([this](const PeriodicFrameView &frame) {
+      if (++this->count_ < this->every_)
+        return;
+      this->count_ = 0;
+      this->trigger(frame);
+    });
+  }
+
+ protected:
+  uint32_t every_;
+  uint32_t count_{0};
+};
+#endif
+
+#ifdef USE_LD2412_BACKGROUND_CORRECTION
+// on_background_correction_complete: duration of the correction in ms
+class BackgroundCorrectionTrigger : public Trigger<uint32_t> {
+ public:
+  explicit BackgroundCorrectionTrigger(LD2412Component *parent) {
+    parent->add_on_background_correction_callback([this](uint32_t duration) { this->trigger(duration); });
+  }
+};
+#endif
+
+#ifdef USE_LD2412_TRACE
+template<typename... Ts> class DumpTraceAction : public Action<Ts...> {
+ public:
+  explicit DumpTraceAction(LD2412Component *LD2412_comp) : LD2412_comp_(LD2412_comp) {}
+
+  void play(Ts... x) override { this->LD2412_comp_->dump_trace(); }
+
+ protected:
+  LD2412Component *LD2412_comp_;
+};
+#endif
+
+#ifdef USE_LD2412_COMMAND_STATS
+template<typename... Ts> class DumpCommandStatsAction : public Action<Ts...> {
+ public:
+  explicit DumpCommandStatsAction(LD2412Component *LD2412_comp) : LD2412_comp_(LD2412_comp) {}
+
+  void play(Ts... x) override { this->LD2412_comp_->dump_command_stats(); }
+
+ protected:
+  LD2412Component *LD2412_comp_;
+};
+#endif
+
+#ifdef USE_LD2412_STATS
+template<typename... Ts> class DumpStatsAction : public Action<Ts...> {
+ public:
+  explicit DumpStatsAction(LD2412Component *LD2412_comp) : LD2412_comp_(LD2412_comp) {}
+
+  void play(Ts... x) override { this->LD2412_comp_->dump_stats(); }
+
+ protected:
+  LD2412Component *LD2412_comp_;
+};
+#endif
+
+#ifdef USE_LD2412_HISTORY
+template<typename... Ts> class DumpHistoryAction : public Action<Ts...> {
+ public:
+  explicit DumpHistoryAction(LD2412Component *LD2412_comp) : LD2412_comp_(LD2412_comp) {}
+
+  void play(Ts... x) override { this->LD2412_comp_->dump_history(); }
+
+ protected:
+  LD2412Component *LD2412_comp_;
+};
+#endif
+
 }  // namespace LD2412
 }  // namespace esphome
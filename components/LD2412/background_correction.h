@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+// Delay of the first query after the start, doubled after every query still reporting the correction
+static const uint32_t BACKGROUND_POLL_MIN_INTERVAL = 1000;
+static const uint32_t BACKGROUND_POLL_MAX_INTERVAL = 16000;
+// Longest wait for the ACKs of a query session before it is closed and retried later
+static const uint32_t BACKGROUND_SESSION_TIMEOUT = 1000;
+// The correction is given up after this many expected durations
+static const uint8_t BACKGROUND_GIVE_UP_FACTOR = 4;
+
+enum BackgroundCorrectionState : uint8_t {
+  BACKGROUND_IDLE,
+  // waiting for the next query, frames flow normally
+  BACKGROUND_RUNNING,
+  // query session: config mode requested, then query sent
+  BACKGROUND_ENTERING_CONFIG,
+  BACKGROUND_QUERYING,
+};
+
+/*
+  Dynamic background correction tracking. The module only tells whether the correction is
+  still running, so progress and remaining time are estimated from the expected duration,
+  which is replaced by the measured one after each completed correction. Queries back off
+  exponentially and come closer again around the expected end.
+*/
+class BackgroundCorrection {
+ public:
+  void set_expected_duration(uint32_t duration) { this->expected_duration_ = duration; }
+  uint32_t get_expected_duration() const { return this->expected_duration_; }
+
+  BackgroundCorrectionState state() const { return this->state_; }
+  bool active() const { return this->state_ != BACKGROUND_IDLE; }
+
+  void start(uint32_t now) {
+    this->state_ = BACKGROUND_RUNNING;
+    this->start_millis_ = now;
+    this->poll_interval_ = BACKGROUND_POLL_MIN_INTERVAL;
+    this->next_poll_millis_ = now + BACKGROUND_POLL_MIN_INTERVAL;
+    this->overdue_ = false;
+  }
+  // Returns the duration in ms
+  uint32_t finish(uint32_t now, bool completed) {
+    uint32_t duration = this->elapsed(now);
+    this->state_ = BACKGROUND_IDLE;
+    if (completed)
+      this->expected_duration_ = duration;
+    return duration;
+  }
+
+  bool poll_due(uint32_t now) const {
+    return this->state_ == BACKGROUND_RUNNING && int32_t(now - this->next_poll_millis_) >= 0;
+  }
+  bool given_up(uint32_t now) const {
+    return this->elapsed(now) > BACKGROUND_GIVE_UP_FACTOR * this->expected_duration_;
+  }
+
+  void begin_session(uint32_t now) {
+    this->state_ = BACKGROUND_ENTERING_CONFIG;
+    this->session_millis_ = now;
+  }
+  void config_entered() { this->state_ = BACKGROUND_QUERYING; }
+  bool in_session() const {
+    return this->state_ == BACKGROUND_ENTERING_CONFIG || this->state_ == BACKGROUND_QUERYING;
+  }
+  bool session_timed_out(uint32_t now) const {
+    return this->in_session() && now - this->session_millis_ > BACKGROUND_SESSION_TIMEOUT;
+  }
+  // Still running: next query after the backed off interval, but not much after the expected end
+  void reschedule(uint32_t now) {
+    this->state_ = BACKGROUND_RUNNING;
+    uint32_t delay = this->poll_interval_;
+    uint32_t remaining = this->remaining(now);
+    if (remaining > 0 && remaining < delay)
+      delay = remaining > BACKGROUND_POLL_MIN_INTERVAL ? remaining : BACKGROUND_POLL_MIN_INTERVAL;
+    if (remaining == 0 && !this->overdue_) {
+      // past the estimate, start backing off again from the shortest interval
+      this->overdue_ = true;
+      this->poll_interval_ = BACKGROUND_POLL_MIN_INTERVAL;
+      delay = BACKGROUND_POLL_MIN_INTERVAL;
+    }
+    this->next_poll_millis_ = now + delay;
+    this->poll_interval_ = this->poll_interval_ * 2 < BACKGROUND_POLL_MAX_INTERVAL ? this->poll_interval_ * 2
+                                                                                   : BACKGROUND_POLL_MAX_INTERVAL;
+  }
+
+  uint32_t elapsed(uint32_t now) const { return now - this->start_millis_; }
+  // Estimated, 0 once the expected duration has passed
+  uint32_t remaining(uint32_t now) const {
+    uint32_t elapsed = this->elapsed(now);
+    return elapsed < this->expected_duration_ ? this->expected_duration_ - elapsed : 0;
+  }
+  // Estimated, in %, held at 99 until the module reports the end
+  float progress(uint32_t now) const {
+    if (!this->active())
+      return 100;
+    float progress = 100.0f * this->elapsed(now) / this->expected_duration_;
+    return progress < 99 ? progress : 99;
+  }
+
+ protected:
+  BackgroundCorrectionState state_{BACKGROUND_IDLE};
+  uint32_t expected_duration_{120000};
+  uint32_t start_millis_{0};
+  uint32_t next_poll_millis_{0};
+  uint32_t poll_interval_{BACKGROUND_POLL_MIN_INTERVAL};
+  uint32_t session_millis_{0};
+  bool overdue_{false};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -5,17 +5,50 @@ from esphome.const import (
     DEVICE_CLASS_MOTION,
     DEVICE_CLASS_OCCUPANCY,
     DEVICE_CLASS_PRESENCE,
+    DEVICE_CLASS_PROBLEM,
+    DEVICE_CLASS_CONNECTIVITY,
     ENTITY_CATEGORY_DIAGNOSTIC,
     ICON_MOTION_SENSOR,
     ICON_ACCOUNT,
+    ICON_SIGNAL,
     CONF_HAS_TARGET,
     CONF_HAS_MOVING_TARGET,
     CONF_HAS_STILL_TARGET,
 )
-from . import CONF_LD2412_ID, LD2412Component
+from . import (
+    CONF_LD2412_ID,
+    CONF_ZONES,
+    CONF_START_GATE,
+    CONF_END_GATE,
+    MAX_ZONES,
+    LD2412Component,
+    validate_zone_gates,
+    require_hub_option,
+    CONF_WATCHDOG,
+)
 
 DEPENDENCIES = ["LD2412"]
 CONF_OUT_PIN_PRESENCE_STATUS = "out_pin_presence_status"
+CONF_MOVE_THRESHOLD = "move_threshold"
+CONF_STILL_THRESHOLD = "still_threshold"
+CONF_ONLINE = "online"
+CONF_INTERFERENCE = "interference"
+CONF_EVENT_RATE = "event_rate"
+
+ZONE_SCHEMA = cv.All(
+    binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY,
+        icon=ICON_ACCOUNT,
+    ).extend(
+        {
+            cv.Required(CONF_START_GATE): cv.int_range(min=0, max=13),
+            cv.Required(CONF_END_GATE): cv.int_range(min=0, max=13),
+            cv.Optional(CONF_MOVE_THRESHOLD, default=50): cv.int_range(min=0, max=100),
+            cv.Optional(CONF_STILL_THRESHOLD, default=50): cv.int_range(min=0, max=100),
+        }
+    ),
+    validate_zone_gates,
+)
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_LD2412_ID): cv.use_id(LD2412Component),
@@ -36,6 +69,23 @@ CONFIG_SCHEMA = {
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
         icon=ICON_ACCOUNT,
     ),
+    cv.Optional(CONF_ONLINE): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_CONNECTIVITY,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    cv.Optional(CONF_INTERFERENCE): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_PROBLEM,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        icon=ICON_SIGNAL,
+    ).extend(
+        {
+            # frames per second with spikes on non-adjacent gates
+            cv.Optional(CONF_EVENT_RATE, default=0.5): cv.positive_float,
+        }
+    ),
+    cv.Optional(CONF_ZONES): cv.All(
+        cv.ensure_list(ZONE_SCHEMA), cv.Length(min=1, max=MAX_ZONES)
+    ),
 }
 
 
@@ -53,3 +103,29 @@ async def to_code(config):
     if out_pin_presence_status_config := config.get(CONF_OUT_PIN_PRESENCE_STATUS):
         sens = await binary_sensor.new_binary_sensor(out_pin_presence_status_config)
         cg.add(LD2412_component.set_out_pin_presence_status_binary_sensor(sens))
+    if online_config := config.get(CONF_ONLINE):
+        # only reports, the watchdog of the hub decides when the module is offline
+        require_hub_option(CONF_ONLINE, config[CONF_LD2412_ID], CONF_WATCHDOG)
+        sens = await binary_sensor.new_binary_sensor(online_config)
+        cg.add(LD2412_component.set_online_binary_sensor(sens))
+    if interference_config := config.get(CONF_INTERFERENCE):
+        cg.add_define("USE_LD2412_INTERFERENCE")
+        sens = await binary_sensor.new_binary_sensor(interference_config)
+        cg.add(LD2412_component.set_interference_binary_sensor(sens))
+        cg.add(
+            LD2412_component.set_interference_threshold(
+                interference_config[CONF_EVENT_RATE]
+            )
+        )
+    for zone_config in config.get(CONF_ZONES, []):
+        cg.add_define("USE_LD2412_ZONE_OCCUPANCY")
+        sens = await binary_sensor.new_binary_sensor(zone_config)
+        cg.add(
+            LD2412_component.add_zone_binary_sensor(
+                zone_config[CONF_START_GATE],
+                zone_config[CONF_END_GATE],
+                zone_config[CONF_MOVE_THRESHOLD],
+                zone_config[CONF_STILL_THRESHOLD],
+                sens,
+            )
+        )
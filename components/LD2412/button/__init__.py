@@ -16,8 +16,12 @@ from .. import CONF_LD2412_ID, LD2412Component, LD2412_ns
 QueryButton = LD2412_ns.class_("QueryButton", button.Button)
 ResetButton = LD2412_ns.class_("ResetButton", button.Button)
 RestartButton = LD2412_ns.class_("RestartButton", button.Button)
+DumpHistoryButton = LD2412_ns.class_("DumpHistoryButton", button.Button)
 
 CONF_QUERY_PARAMS = "query_params"
+CONF_DUMP_HISTORY = "dump_history"
+
+ICON_HISTORY = "mdi:history"
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_LD2412_ID): cv.use_id(LD2412Component),
@@ -38,6 +42,11 @@ CONFIG_SCHEMA = {
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
         icon=ICON_DATABASE,
     ),
+    cv.Optional(CONF_DUMP_HISTORY): button.button_schema(
+        DumpHistoryButton,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        icon=ICON_HISTORY,
+    ),
 }
 
 
@@ -55,3 +64,6 @@ async def to_code(config):
         b = await button.new_button(query_params_config)
         await cg.register_parented(b, config[CONF_LD2412_ID])
         cg.add(LD2412_component.set_query_button(b))
+    if dump_history_config := config.get(CONF_DUMP_HISTORY):
+        b = await button.new_button(dump_history_config)
+        await cg.register_parented(b, config[CONF_LD2412_ID])
@@ -0,0 +1,13 @@
+#include "dump_history_button.h"
+
+namespace esphome {
+namespace LD2412 {
+
+void DumpHistoryButton::press_action() {
+#ifdef USE_LD2412_HISTORY
+  this->parent_->dump_history();
+#endif
+}
+
+}  // namespace LD2412
+}  // namespace esphome
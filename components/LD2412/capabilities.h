@@ -0,0 +1,62 @@
+#pragma once
+#include "frame_views.h"
+
+namespace esphome {
+namespace LD2412 {
+
+// Largest gate count accepted when learning the layout of an unknown firmware
+static const uint8_t MAX_FIRMWARE_GATES = 32;
+
+/*
+  What the running firmware can do, derived from CMD_VERSION then refined by what the
+  module actually sends: the engineering frame layout is checked against the first
+  engineering frame and commands answered with an error are turned off.
+*/
+struct Capabilities {
+  // 0 until CMD_VERSION has been answered
+  uint8_t firmware_major{0};
+  uint8_t gates{FRAME_GATES};
+  // frame end bytes included
+  uint8_t engineering_frame_size{ENGINEERING_FRAME_SIZE};
+  // the OUT pin state follows the light value in engineering frames
+  bool out_pin_in_frame{false};
+  bool light_control{true};
+  bool background_query{true};
+
+  // 14 gates: frames are read in place, any other count goes through a copy into that layout
+  bool standard_layout() const { return this->gates == FRAME_GATES; }
+
+  // Engineering payload: data type, head, target, 2 max gates, 2 energies per gate, light, [OUT pin], tail
+  static constexpr uint8_t engineering_size(uint8_t gates, bool out_pin) {
+    return sizeof(EngineeringFrame) - 2 * FRAME_GATES + 2 * gates + out_pin + sizeof(PeriodicFrameTail) +
+           FRAME_FOOTER_SIZE;
+  }
+
+  void set_layout(uint8_t gates, bool out_pin) {
+    this->gates = gates;
+    this->out_pin_in_frame = out_pin;
+    this->engineering_frame_size = engineering_size(gates, out_pin);
+  }
+
+  // Layout of an engineering frame of the given length, false if it cannot be one
+  static bool layout_from_size(int len, uint8_t &gates, bool &out_pin) {
+    int energies = len - engineering_size(0, false);
+    if (energies < 2)
+      return false;
+    gates = energies / 2;
+    out_pin = energies % 2;
+    return gates <= MAX_FIRMWARE_GATES;
+  }
+
+  void update_from_version(const AckVersionFrame *frame) {
+    this->firmware_major = frame->major[1];
+    // Every V1 firmware has 14 gates. Later ones start from the same assumptions,
+    // which are corrected by the frames and ACKs they send.
+  }
+};
+
+static_assert(Capabilities::engineering_size(FRAME_GATES, false) == ENGINEERING_FRAME_SIZE,
+              "engineering layout for 14 gates");
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -0,0 +1,148 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+enum AckError : uint8_t {
+  // no ACK within COMMAND_ACK_TIMEOUT_US
+  ACK_TIMEOUT,
+  // command frame dropped by the parser: length beyond the buffer, or end bytes not matching its header
+  ACK_BAD_HEADER,
+  // status byte other than 0x01
+  ACK_BAD_STATUS,
+  ACK_NONZERO_RESULT,
+  // shorter than the frame of its command
+  ACK_TRUNCATED,
+  ACK_ERROR_TYPES,
+};
+
+static const char *const ACK_ERROR_NAMES[ACK_ERROR_TYPES] = {
+    "timeout", "bad header", "bad status", "nonzero result", "truncated",
+};
+
+// No command has this id, for errors of ACKs too short to tell their command
+static const uint8_t COMMAND_UNKNOWN = 0x00;
+
+}  // namespace LD2412
+}  // namespace esphome
+
+#ifdef USE_LD2412_COMMAND_STATS
+namespace esphome {
+namespace LD2412 {
+
+// Commands tracked, those sent after the table is full only count in the totals
+static const uint8_t COMMAND_STATS_SLOTS = 16;
+static const uint8_t LATENCY_BUCKETS = 8;
+// Upper bounds of the buckets in us, the last bucket takes everything above
+static const uint32_t LATENCY_BUCKET_LIMITS[LATENCY_BUCKETS - 1] = {2000, 5000, 10000, 20000, 50000, 100000, 200000};
+static const uint32_t COMMAND_ACK_TIMEOUT_US = 1000000;
+
+struct CommandLatency {
+  uint8_t command;
+  bool pending;
+  // micros() when the command was written
+  uint32_t sent;
+  // saturate at UINT16_MAX
+  uint16_t buckets[LATENCY_BUCKETS];
+  uint16_t errors;
+  uint32_t count;
+  uint32_t max_us;
+  uint64_t total_us;
+};
+
+/*
+  Round trip time of each command, from its write to the arrival of its ACK, in a fixed
+  bucket histogram per command id, and the ACK errors by type. One command of each id is
+  expected at a time: a command written again before its ACK restarts its timing.
+*/
+class CommandStats {
+ public:
+  void sent(uint8_t command, uint32_t now) {
+    CommandLatency *slot = this->slot_(command, true);
+    if (slot == nullptr)
+      return;
+    if (!slot->pending)
+      this->pending_++;
+    slot->pending = true;
+    slot->sent = now;
+  }
+
+  // Returns the round trip time in us, 0 when the command was not pending
+  uint32_t acked(uint8_t command, uint32_t now) {
+    CommandLatency *slot = this->slot_(command, false);
+    if (slot == nullptr || !slot->pending)
+      return 0;
+    slot->pending = false;
+    this->pending_--;
+    uint32_t latency = now - slot->sent;
+    uint8_t bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && latency > LATENCY_BUCKET_LIMITS[bucket])
+      bucket++;
+    if (slot->buckets[bucket] != UINT16_MAX)
+      slot->buckets[bucket]++;
+    slot->count++;
+    slot->total_us += latency;
+    if (latency > slot->max_us)
+      slot->max_us = latency;
+    this->count_++;
+    this->total_us_ += latency;
+    if (latency > this->max_us_)
+      this->max_us_ = latency;
+    return latency;
+  }
+
+  void error(AckError error, uint8_t command) {
+    this->errors_[error]++;
+    CommandLatency *slot = this->slot_(command, false);
+    if (slot != nullptr && slot->errors != UINT16_MAX)
+      slot->errors++;
+  }
+
+  bool has_pending() const { return this->pending_ != 0; }
+  // Counts the commands still without ACK after COMMAND_ACK_TIMEOUT_US as timed out
+  void expire(uint32_t now) {
+    for (uint8_t i = 0; i < this->used_; i++) {
+      CommandLatency &slot = this->slots_[i];
+      if (slot.pending && now - slot.sent > COMMAND_ACK_TIMEOUT_US) {
+        slot.pending = false;
+        this->pending_--;
+        this->error(ACK_TIMEOUT, slot.command);
+      }
+    }
+  }
+
+  uint8_t size() const { return this->used_; }
+  const CommandLatency &at(uint8_t index) const { return this->slots_[index]; }
+  uint32_t errors(AckError error) const { return this->errors_[error]; }
+  uint32_t count() const { return this->count_; }
+  // in us, over all commands
+  float mean() const { return this->count_ == 0 ? 0 : float(this->total_us_) / this->count_; }
+  uint32_t max() const { return this->max_us_; }
+
+ protected:
+  CommandLatency *slot_(uint8_t command, bool add) {
+    for (uint8_t i = 0; i < this->used_; i++) {
+      if (this->slots_[i].command == command)
+        return &this->slots_[i];
+    }
+    if (!add || this->used_ == COMMAND_STATS_SLOTS)
+      return nullptr;
+    CommandLatency &slot = this->slots_[this->used_++];
+    slot.command = command;
+    return &slot;
+  }
+
+  CommandLatency slots_[COMMAND_STATS_SLOTS]{};
+  uint8_t used_{0};
+  uint8_t pending_{0};
+  uint32_t errors_[ACK_ERROR_TYPES]{};
+  uint32_t count_{0};
+  uint64_t total_us_{0};
+  uint32_t max_us_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
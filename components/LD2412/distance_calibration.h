@@ -0,0 +1,84 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#endif
+
+namespace esphome {
+namespace LD2412 {
+
+/*
+  Gate size in cm for each distance resolution code, indexed by the code itself:
+  0x00 = 0.75m, 0x01 = 0.5m, 0x03 = 0.2m (0x02 is not used by the module)
+*/
+static const uint8_t GATE_SIZE_CM[4] = {75, 50, 0, 20};
+static const uint8_t DEFAULT_GATE_SIZE_CM = 75;
+
+inline uint8_t gate_size_cm(uint8_t resolution) {
+  return resolution < sizeof(GATE_SIZE_CM) && GATE_SIZE_CM[resolution] != 0 ? GATE_SIZE_CM[resolution]
+                                                                            : DEFAULT_GATE_SIZE_CM;
+}
+
+#ifdef USE_LD2412_DISTANCE_CALIBRATION
+/*
+  Per-installation correction of the reported distances: either linear (scale and offset)
+  or piecewise linear through measured points, extrapolated from the outer segments.
+  The correction is evaluated once per cm of the detection range of the current resolution
+  when the resolution is known, frames then cost a single table lookup per distance.
+*/
+class DistanceCalibration {
+ public:
+  void set_linear(float scale, float offset) {
+    this->scale_ = scale;
+    this->offset_ = offset;
+  }
+  // Points must be added by increasing raw distance
+  void add_point(uint16_t raw, uint16_t actual) { this->points_.push_back({raw, actual}); }
+
+  void build(uint16_t max_distance) {
+    this->table_.resize(max_distance + 1);
+    for (uint16_t raw = 0; raw <= max_distance; raw++) {
+      float corrected = std::round(this->evaluate_(raw));
+      this->table_[raw] = static_cast<uint16_t>(std::max(0.0f, std::min(corrected, 65535.0f)));
+    }
+  }
+  size_t table_size() const { return this->table_.size(); }
+
+  uint16_t apply(uint16_t raw) const {
+    if (this->table_.empty())
+      return raw;
+    return this->table_[std::min<size_t>(raw, this->table_.size() - 1)];
+  }
+
+ protected:
+  struct Point {
+    uint16_t raw;
+    uint16_t actual;
+  };
+
+  float evaluate_(uint16_t raw) const {
+    if (this->points_.size() < 2)
+      return raw * this->scale_ + this->offset_;
+    size_t i = 1;
+    while (i < this->points_.size() - 1 && raw > this->points_[i].raw)
+      i++;
+    const Point &a = this->points_[i - 1];
+    const Point &b = this->points_[i];
+    if (a.raw == b.raw)
+      return b.actual;
+    return a.actual + (float(raw) - a.raw) * (float(b.actual) - a.actual) / (float(b.raw) - a.raw);
+  }
+
+  float scale_{1.0f};
+  float offset_{0.0f};
+  std::vector<Point> points_;
+  std::vector<uint16_t> table_;
+};
+#endif
+
+}  // namespace LD2412
+}  // namespace esphome
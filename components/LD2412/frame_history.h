@@ -0,0 +1,83 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_LD2412_HISTORY
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace LD2412 {
+
+static const uint32_t HISTORY_MAX_DELTA_MS = (1UL << 22) - 1;
+static const uint16_t HISTORY_MAX_DISTANCE = (1U << 12) - 1;
+// 14 moving gate energies, 14 still gate energies and the light value, as laid out in the engineering frame
+static const uint8_t HISTORY_GATE_BYTES = 29;
+
+/*
+  One periodic frame packed in 8 bytes (plus the raw gate energies when enabled).
+  Timestamps are stored as the delta with the previous record, the absolute time
+  of the newest record is kept by the FrameHistory.
+*/
+struct __attribute__((packed)) FrameRecord {
+  uint64_t delta_ms : 22;
+  uint64_t target_state : 2;
+  uint64_t engineering_mode : 1;
+  uint64_t throttled : 1;
+  uint64_t moving_distance : 12;
+  uint64_t moving_energy : 7;
+  uint64_t still_distance : 12;
+  uint64_t still_energy : 7;
+#ifdef USE_LD2412_HISTORY_GATES
+  uint8_t gates[HISTORY_GATE_BYTES];
+#endif
+};
+
+#ifdef USE_LD2412_HISTORY_GATES
+static_assert(sizeof(FrameRecord) == 8 + HISTORY_GATE_BYTES, "FrameRecord must stay bit-packed");
+#else
+static_assert(sizeof(FrameRecord) == 8, "FrameRecord must stay bit-packed");
+#endif
+
+/*
+  Fixed-size ring buffer of the last frames. Storage is allocated once by init(),
+  push() overwrites the oldest record when full.
+*/
+class FrameHistory {
+ public:
+  void init(size_t capacity) {
+    this->records_.resize(capacity);
+    this->head_ = 0;
+    this->count_ = 0;
+  }
+  size_t capacity() const { return this->records_.size(); }
+  size_t size() const { return this->count_; }
+  uint32_t last_millis() const { return this->last_millis_; }
+
+  void push(const FrameRecord &record, uint32_t now) {
+    if (this->records_.empty())
+      return;
+    this->records_[this->head_] = record;
+    if (++this->head_ == this->records_.size())
+      this->head_ = 0;
+    if (this->count_ < this->records_.size())
+      this->count_++;
+    this->last_millis_ = now;
+  }
+
+  // index 0 is the oldest record
+  const FrameRecord &at(size_t index) const {
+    size_t pos = this->head_ + this->records_.size() - this->count_ + index;
+    if (pos >= this->records_.size())
+      pos -= this->records_.size();
+    return this->records_[pos];
+  }
+
+ protected:
+  std::vector<FrameRecord> records_;
+  size_t head_{0};
+  size_t count_{0};
+  uint32_t last_millis_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "frame_views.h"
+
+namespace esphome {
+namespace LD2412 {
+
+// Command Header & Footer
+static const uint8_t CMD_FRAME_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+static const uint8_t CMD_FRAME_END[4] = {0x04, 0x03, 0x02, 0x01};
+// Data Header & Footer
+static const uint8_t DATA_FRAME_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+static const uint8_t DATA_FRAME_END[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+
+// Longest frame accepted by the parser, the longest known one is the 52 bytes engineering frame
+static const uint8_t MAX_FRAME_LENGTH = 80;
+
+enum FrameParseResult : int {
+  FRAME_INCOMPLETE = 0,
+  // The length field is beyond the buffer, the bytes read so far are dropped
+  FRAME_BAD_LENGTH = -1,
+  // The frame end bytes do not match its header, the frame is dropped
+  FRAME_BAD_FOOTER = -2,
+};
+
+/*
+  Assembles frames byte by byte. The header selects the frame type, the length field gives
+  where the frame ends, so values that look like frame end bytes (e.g. in a MAC) don't cut it.
+  Anything unexpected drops the bytes read so far and waits for the next header. Kept free
+  of ESPHome so that tools/fuzz_frame_parser.cpp runs it on the host.
+*/
+class FrameParser {
+ public:
+  // Returns the frame length once a complete frame is in buffer, a FrameParseResult otherwise
+  int feed(uint8_t byte, uint8_t *buffer, int len) {
+    uint8_t pos = this->pos_;
+    if (pos > 0 && pos < sizeof(FrameHeader::header)) {
+      const uint8_t *header = buffer[0] == DATA_FRAME_HEADER[0] ? DATA_FRAME_HEADER : CMD_FRAME_HEADER;
+      // The byte may start the next frame
+      if (byte != header[pos])
+        pos = 0;
+    }
+    if (pos == 0 && byte != DATA_FRAME_HEADER[0] && byte != CMD_FRAME_HEADER[0]) {
+      this->pos_ = 0;
+      return FRAME_INCOMPLETE;
+    }
+    buffer[pos++] = byte;
+    this->pos_ = pos;
+    if (pos < sizeof(FrameHeader))
+      return FRAME_INCOMPLETE;
+
+    int frame_len = frame_length(buffer);
+    if (frame_len > len) {
+      this->pos_ = 0;
+      return FRAME_BAD_LENGTH;
+    }
+    if (pos < frame_len)
+      return FRAME_INCOMPLETE;
+
+    this->pos_ = 0;
+    const uint8_t *footer = buffer[0] == DATA_FRAME_HEADER[0] ? DATA_FRAME_END : CMD_FRAME_END;
+    if (memcmp(&buffer[frame_len - FRAME_FOOTER_SIZE], footer, FRAME_FOOTER_SIZE) != 0)
+      return FRAME_BAD_FOOTER;
+    return frame_len;
+  }
+
+  // Whole frame length from its header, footer included
+  static int frame_length(const uint8_t *buffer) {
+    return le16(reinterpret_cast<const FrameHeader *>(buffer)->length) + sizeof(FrameHeader) + FRAME_FOOTER_SIZE;
+  }
+  // Bytes of the frame being assembled
+  uint8_t position() const { return this->pos_; }
+
+ protected:
+  uint8_t pos_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -0,0 +1,135 @@
+#include "frame_stream.h"
+#ifdef USE_LD2412_STREAM
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace LD2412 {
+
+static const char *const TAG = "LD2412.stream";
+
+static const uint32_t RECONNECT_INTERVAL = 5000;
+// raw records are prefixed by their timestamp and length
+static const uint8_t MAX_RAW_RECORD_SIZE = 4 + 1 + MAX_FRAME_LENGTH;
+
+void FrameStreamer::setup() {
+  size_t record_size = this->raw_ ? MAX_RAW_RECORD_SIZE : sizeof(StreamFrameRecord);
+  this->batch_.reserve(sizeof(StreamBatchHeader) + this->batch_size_ * record_size);
+  this->connect_();
+}
+
+void FrameStreamer::dump_config() {
+  ESP_LOGCONFIG(TAG, "  Stream : %s://%s:%u, %u frames per batch or every %ums, %s records",
+                this->tcp_ ? "tcp" : "udp", this->host_.c_str(), this->port_, this->batch_size_,
+                (unsigned) this->flush_interval_, this->raw_ ? "raw" : "decoded");
+  ESP_LOGCONFIG(TAG, "  Stream batches sent : %u, dropped : %u", (unsigned) this->sent_batches_,
+                (unsigned) this->dropped_batches_);
+}
+
+bool FrameStreamer::connect_() {
+  this->last_connect_attempt_ = millis();
+  this->socket_ = socket::socket(AF_INET, this->tcp_ ? SOCK_STREAM : SOCK_DGRAM, this->tcp_ ? IPPROTO_TCP : IPPROTO_UDP);
+  if (this->socket_ == nullptr) {
+    ESP_LOGW(TAG, "Could not create socket");
+    return false;
+  }
+  this->socket_->setblocking(false);
+  struct sockaddr_storage server;
+  socklen_t server_len = socket::set_sockaddr((struct sockaddr *) &server, sizeof(server), this->host_, this->port_);
+  if (server_len == 0) {
+    ESP_LOGW(TAG, "Invalid stream address %s", this->host_.c_str());
+    this->socket_ = nullptr;
+    return false;
+  }
+  // UDP sockets are connected too, so both protocols can use write()
+  if (this->socket_->connect((struct sockaddr *) &server, server_len) != 0 && errno != EINPROGRESS) {
+    ESP_LOGW(TAG, "Could not connect to %s:%u, errno %d", this->host_.c_str(), this->port_, errno);
+    this->socket_->close();
+    this->socket_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void FrameStreamer::add_frame(const PeriodicFrameView &frame) {
+  if (this->frames_in_batch_ == 0) {
+    this->batch_.resize(sizeof(StreamBatchHeader));
+  }
+  if (this->raw_) {
+    uint8_t record_len = std::min<size_t>(frame.size(), MAX_FRAME_LENGTH);
+    uint32_t timestamp = frame.timestamp();
+    const uint8_t *timestamp_bytes = reinterpret_cast<const uint8_t *>(&timestamp);
+    this->batch_.insert(this->batch_.end(), timestamp_bytes, timestamp_bytes + sizeof(timestamp));
+    this->batch_.push_back(record_len);
+    this->batch_.insert(this->batch_.end(), frame.data(), frame.data() + record_len);
+  } else {
+    StreamFrameRecord record{};
+    record.timestamp = frame.timestamp();
+    record.target_state = frame.target_state();
+    record.engineering_mode = frame.is_engineering();
+    record.moving_distance = frame.moving_distance();
+    record.moving_energy = frame.moving_energy();
+    record.still_distance = frame.still_distance();
+    record.still_energy = frame.still_energy();
+    if (frame.is_engineering()) {
+      memcpy(record.move_energies, frame.moving_energies(), sizeof(record.move_energies));
+      memcpy(record.still_energies, frame.still_energies(), sizeof(record.still_energies));
+      record.light = frame.light();
+    }
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&record);
+    this->batch_.insert(this->batch_.end(), bytes, bytes + sizeof(record));
+  }
+  if (++this->frames_in_batch_ >= this->batch_size_) {
+    this->flush_();
+  }
+}
+
+void FrameStreamer::flush() {
+  if (this->frames_in_batch_ != 0)
+    this->flush_();
+}
+
+void FrameStreamer::flush_() {
+  StreamBatchHeader header;
+  memcpy(header.magic, STREAM_MAGIC, sizeof(header.magic));
+  header.version = STREAM_VERSION;
+  header.flags = this->raw_ ? STREAM_FLAG_RAW : 0;
+  header.frame_count = this->frames_in_batch_;
+  header.sequence = this->sequence_;
+  memcpy(this->batch_.data(), &header, sizeof(header));
+  this->sequence_ += this->frames_in_batch_;
+  this->frames_in_batch_ = 0;
+
+  if (this->socket_ == nullptr) {
+    this->dropped_batches_++;
+    if (millis() - this->last_connect_attempt_ > RECONNECT_INTERVAL)
+      this->connect_();
+    return;
+  }
+  ssize_t written = this->socket_->write(this->batch_.data(), this->batch_.size());
+  if (written == (ssize_t) this->batch_.size()) {
+    this->sent_batches_++;
+    return;
+  }
+  this->dropped_batches_++;
+  if (written >= 0) {
+    // Only on TCP: the rest of the stream would be read from the middle of this batch, a new
+    // connection starts again on a batch header
+    ESP_LOGW(TAG, "Stream batch cut after %d of %u bytes, reconnecting", (int) written,
+             (unsigned) this->batch_.size());
+  } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOTCONN || errno == EINPROGRESS) {
+    // A full socket buffer or a TCP connection still being established only loses this batch
+    return;
+  } else {
+    ESP_LOGW(TAG, "Stream write failed, errno %d, reconnecting", errno);
+  }
+  this->socket_->close();
+  this->socket_ = nullptr;
+}
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
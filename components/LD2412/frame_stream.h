@@ -0,0 +1,91 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_LD2412_STREAM
+#include "esphome/components/socket/socket.h"
+#include "frame_parser.h"
+#include "frame_views.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace LD2412 {
+
+static const uint8_t STREAM_MAGIC[2] = {'L', '2'};
+// 2: records carry the frame arrival time in us
+static const uint8_t STREAM_VERSION = 2;
+static const uint8_t STREAM_FLAG_RAW = 0x01;
+
+/*
+  Every datagram (UDP) or write (TCP) is one batch: a header followed by frame_count records.
+  Multi-byte values are little-endian.
+*/
+struct __attribute__((packed)) StreamBatchHeader {
+  uint8_t magic[2];
+  uint8_t version;
+  uint8_t flags;
+  uint16_t frame_count;
+  // sequence number of the first frame of the batch, gaps mean lost frames
+  uint32_t sequence;
+};
+
+// Decoded record, gate energies and light are zero for normal mode frames
+struct __attribute__((packed)) StreamFrameRecord {
+  // micros() when the frame footer arrived
+  uint32_t timestamp;
+  uint8_t target_state;
+  uint8_t engineering_mode;
+  uint16_t moving_distance;
+  uint8_t moving_energy;
+  uint16_t still_distance;
+  uint8_t still_energy;
+  uint8_t move_energies[14];
+  uint8_t still_energies[14];
+  uint8_t light;
+};
+static_assert(sizeof(StreamFrameRecord) == 41, "StreamFrameRecord layout is part of the stream format");
+
+// Raw records are the timestamp (uint32_t us), a length byte, then the frame as received on the UART
+
+class FrameStreamer {
+ public:
+  void set_host(const std::string &host) { this->host_ = host; }
+  void set_port(uint16_t port) { this->port_ = port; }
+  void set_tcp(bool tcp) { this->tcp_ = tcp; }
+  void set_batch_size(uint8_t batch_size) { this->batch_size_ = batch_size; }
+  void set_raw(bool raw) { this->raw_ = raw; }
+  void set_flush_interval(uint32_t flush_interval) { this->flush_interval_ = flush_interval; }
+  uint32_t get_flush_interval() const { return this->flush_interval_; }
+  // Other radars of the build may stream, this one only with an address
+  bool is_configured() const { return this->port_ != 0; }
+
+  void setup();
+  void dump_config();
+  void add_frame(const PeriodicFrameView &frame);
+  // Sends the frames batched so far, called on the flush interval so that they do not wait for a full batch
+  void flush();
+
+ protected:
+  bool connect_();
+  void flush_();
+
+  std::unique_ptr<socket::Socket> socket_;
+  std::vector<uint8_t> batch_;
+  std::string host_;
+  uint16_t port_{0};
+  bool tcp_{false};
+  bool raw_{false};
+  uint8_t batch_size_{8};
+  uint32_t flush_interval_{1000};
+  uint8_t frames_in_batch_{0};
+  uint32_t sequence_{0};
+  uint32_t last_connect_attempt_{0};
+  uint32_t sent_batches_{0};
+  uint32_t dropped_batches_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
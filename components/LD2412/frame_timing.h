@@ -0,0 +1,67 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+// Longer gaps are pauses (config mode, restart), not the frame rate
+static const uint32_t FRAME_TIMING_MAX_INTERVAL_US = 1000000;
+// EWMA weight of a new interval, about the last 16 frames
+static const float FRAME_TIMING_ALPHA = 1.0f / 16;
+
+/*
+  Inter-arrival statistics of the periodic frames, fed with the microsecond timestamps
+  taken when their footer is read. Mean and jitter are smoothed over the last frames,
+  minimum and maximum cover the window since the last reset_window(), one loop stats
+  publish.
+*/
+class FrameTiming {
+ public:
+  // Interval since the previous frame in us, 0 for the first frame and after a pause
+  uint32_t add(uint32_t timestamp) {
+    uint32_t interval = timestamp - this->last_timestamp_;
+    bool first = this->frames_ == 0;
+    this->last_timestamp_ = timestamp;
+    this->frames_++;
+    if (first || interval > FRAME_TIMING_MAX_INTERVAL_US)
+      return 0;
+    if (this->mean_ == 0) {
+      this->mean_ = interval;
+    } else {
+      // Mean deviation of the inter-arrival time, as in RFC 3550
+      float deviation = std::fabs(interval - this->mean_);
+      this->mean_ += FRAME_TIMING_ALPHA * (interval - this->mean_);
+      this->jitter_ += FRAME_TIMING_ALPHA * (deviation - this->jitter_);
+    }
+    if (interval < this->window_min_)
+      this->window_min_ = interval;
+    if (interval > this->window_max_)
+      this->window_max_ = interval;
+    return interval;
+  }
+
+  uint32_t last_timestamp() const { return this->last_timestamp_; }
+  uint32_t frames() const { return this->frames_; }
+  // in us
+  float mean() const { return this->mean_; }
+  float jitter() const { return this->jitter_; }
+  // UINT32_MAX / 0 when no interval was seen in the window
+  uint32_t window_min() const { return this->window_min_; }
+  uint32_t window_max() const { return this->window_max_; }
+  void reset_window() {
+    this->window_min_ = UINT32_MAX;
+    this->window_max_ = 0;
+  }
+
+ protected:
+  uint32_t last_timestamp_{0};
+  uint32_t frames_{0};
+  float mean_{0};
+  float jitter_{0};
+  uint32_t window_min_{UINT32_MAX};
+  uint32_t window_max_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -0,0 +1,216 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "swar.h"
+
+namespace esphome {
+namespace LD2412 {
+
+/*
+  Layouts of the frames sent by the module. Every struct is byte aligned so it can
+  be overlaid on the receive buffer once its length has been checked, fields are
+  then read without any further bounds check. Multi-byte values are little-endian.
+*/
+
+constexpr uint16_t le16(const uint8_t (&bytes)[2]) { return uint16_t(bytes[0]) | (uint16_t(bytes[1]) << 8); }
+constexpr uint32_t le32(const uint8_t (&bytes)[4]) {
+  return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
+static const uint8_t FRAME_GATES = 14;
+// 4 frame end bytes, counted in the buffer but not in the length field
+static const uint8_t FRAME_FOOTER_SIZE = 4;
+
+struct __attribute__((packed)) FrameHeader {
+  uint8_t header[4];
+  // number of bytes between the length field and the frame end bytes
+  uint8_t length[2];
+};
+
+/*
+  Periodic data
+*/
+struct __attribute__((packed)) TargetData {
+  /*
+    0x00 = No target
+    0x01 = Moving targets
+    0x02 = Still targets
+    0x03 = Moving+Still targets
+  */
+  uint8_t target_state;
+  uint8_t moving_distance[2];
+  uint8_t moving_energy;
+  uint8_t still_distance[2];
+  uint8_t still_energy;
+};
+
+struct __attribute__((packed)) PeriodicFrame {
+  FrameHeader header;
+  // 0x01: Engineering mode, 0x02: Normal mode
+  uint8_t data_type;
+  // 0xAA
+  uint8_t head;
+  TargetData target;
+};
+
+struct __attribute__((packed)) EngineeringFrame {
+  PeriodicFrame base;
+  uint8_t max_moving_gate;
+  uint8_t max_still_gate;
+  uint8_t moving_energies[FRAME_GATES];
+  uint8_t still_energies[FRAME_GATES];
+  uint8_t light;
+};
+
+// Closes every periodic frame, right before the frame end bytes
+struct __attribute__((packed)) PeriodicFrameTail {
+  // 0x55
+  uint8_t end;
+  // 0x00
+  uint8_t check;
+};
+
+static const size_t NORMAL_FRAME_SIZE = sizeof(PeriodicFrame) + sizeof(PeriodicFrameTail) + FRAME_FOOTER_SIZE;
+static const size_t ENGINEERING_FRAME_SIZE = sizeof(EngineeringFrame) + sizeof(PeriodicFrameTail) + FRAME_FOOTER_SIZE;
+
+static_assert(offsetof(PeriodicFrame, data_type) == 6, "data type is the 7th byte");
+static_assert(offsetof(PeriodicFrame, target) == 8, "target states is the 9th byte");
+static_assert(offsetof(EngineeringFrame, moving_energies) == 17, "moving energies start at the 18th byte");
+static_assert(offsetof(EngineeringFrame, still_energies) == 31, "still energies start at the 32nd byte");
+static_assert(offsetof(EngineeringFrame, light) == 45, "light is the 46th byte");
+static_assert(NORMAL_FRAME_SIZE == 21, "normal mode frames are 21 bytes");
+static_assert(ENGINEERING_FRAME_SIZE == 52, "engineering mode frames are 52 bytes");
+
+/*
+  Command ACKs
+*/
+struct __attribute__((packed)) AckFrame {
+  FrameHeader header;
+  // low byte of the command
+  uint8_t command;
+  // 0x01 for an ACK
+  uint8_t status;
+  // 0x0000 on success
+  uint8_t result[2];
+};
+
+struct __attribute__((packed)) AckVersionFrame {
+  AckFrame ack;
+  uint8_t type[2];
+  uint8_t major[2];
+  uint8_t minor[4];
+};
+
+struct __attribute__((packed)) AckMacFrame {
+  AckFrame ack;
+  uint8_t mac[6];
+};
+
+struct __attribute__((packed)) AckDistanceResolutionFrame {
+  AckFrame ack;
+  uint8_t resolution[2];
+};
+
+struct __attribute__((packed)) AckQueryFrame {
+  AckFrame ack;
+  uint8_t min_distance_gate;
+  uint8_t max_distance_gate;
+  uint8_t duration[2];
+  uint8_t out_pin_level;
+};
+
+struct __attribute__((packed)) AckGateSensitivityFrame {
+  AckFrame ack;
+  uint8_t gates[FRAME_GATES];
+};
+
+struct __attribute__((packed)) AckBackgroundCorrectionFrame {
+  AckFrame ack;
+  uint8_t active[2];
+};
+
+struct __attribute__((packed)) AckLightControlFrame {
+  AckFrame ack;
+  // 0x00 = off, 0x01 = below threshold, 0x02 = above threshold
+  uint8_t light_function;
+  uint8_t light_threshold;
+  // 0x00 = high when occupied, 0x01 = low when occupied
+  uint8_t out_pin_level;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(AckFrame) == 10, "ACK values start at the 11th byte");
+static_assert(offsetof(AckVersionFrame, minor) == 14, "minor version is at bytes 15~18");
+static_assert(offsetof(AckQueryFrame, out_pin_level) == 14, "out pin level is the 15th byte");
+
+// Returns the typed frame if the buffer holds it and its frame end bytes, nullptr otherwise
+template<typename T> const T *frame_cast(const uint8_t *buffer, size_t len) {
+  return len >= sizeof(T) + FRAME_FOOTER_SIZE ? reinterpret_cast<const T *>(buffer) : nullptr;
+}
+
+/*
+  Zero-copy view of a validated periodic frame. Checks are done once in the constructor,
+  accessors index into the receive buffer directly.
+*/
+class PeriodicFrameView {
+ public:
+  PeriodicFrameView(const uint8_t *buffer, size_t len, uint32_t timestamp = 0)
+      : buffer_(buffer), len_(len), timestamp_(timestamp) {
+    this->frame_ = frame_cast<PeriodicFrame>(buffer, len);
+    if (this->frame_ == nullptr || len < NORMAL_FRAME_SIZE || this->frame_->head != 0xAA ||
+        buffer[len - sizeof(PeriodicFrameTail) - FRAME_FOOTER_SIZE] != 0x55 ||
+        le16(this->frame_->header.length) + sizeof(FrameHeader) + FRAME_FOOTER_SIZE != len) {
+      this->frame_ = nullptr;
+      return;
+    }
+    if (this->frame_->data_type == 0x01 && len >= ENGINEERING_FRAME_SIZE) {
+      this->engineering_ = reinterpret_cast<const EngineeringFrame *>(buffer);
+    }
+  }
+
+  bool is_valid() const { return this->frame_ != nullptr; }
+  bool is_engineering() const { return this->engineering_ != nullptr; }
+  const uint8_t *data() const { return this->buffer_; }
+  size_t size() const { return this->len_; }
+  // micros() when the frame footer arrived on the UART
+  uint32_t timestamp() const { return this->timestamp_; }
+  // us since the previous frame, 0 for the first frame after a pause
+  uint32_t interval() const { return this->interval_; }
+  void set_interval(uint32_t interval) { this->interval_ = interval; }
+
+  uint8_t target_state() const { return this->frame_->target.target_state; }
+  bool has_target() const { return this->target_state() != 0x00; }
+  bool has_moving_target() const { return this->target_state() & 0x01; }
+  bool has_still_target() const { return this->target_state() & 0x02; }
+  uint16_t moving_distance() const { return le16(this->frame_->target.moving_distance); }
+  uint8_t moving_energy() const { return this->frame_->target.moving_energy; }
+  uint16_t still_distance() const { return le16(this->frame_->target.still_distance); }
+  uint8_t still_energy() const { return this->frame_->target.still_energy; }
+  uint16_t detection_distance() const {
+    if (this->has_moving_target())
+      return this->moving_distance();
+    return this->has_target() ? this->still_distance() : 0;
+  }
+
+  // Only valid in engineering mode
+  const uint8_t *moving_energies() const { return this->engineering_->moving_energies; }
+  const uint8_t *still_energies() const { return this->engineering_->still_energies; }
+  uint8_t light() const { return this->engineering_->light; }
+  // First gate with the highest energy
+  uint8_t strongest_moving_gate() const { return GateVector::load(this->moving_energies()).max_gate(); }
+  uint8_t strongest_still_gate() const { return GateVector::load(this->still_energies()).max_gate(); }
+  // Firmwares that report the OUT pin put it between the light value and the frame tail
+  bool has_out_pin() const { return this->is_engineering() && this->len_ > ENGINEERING_FRAME_SIZE; }
+  bool out_pin() const { return this->buffer_[sizeof(EngineeringFrame)] == 0x01; }
+
+ protected:
+  const uint8_t *buffer_;
+  size_t len_;
+  uint32_t timestamp_;
+  uint32_t interval_{0};
+  const PeriodicFrame *frame_{nullptr};
+  const EngineeringFrame *engineering_{nullptr};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
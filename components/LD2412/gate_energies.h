@@ -0,0 +1,40 @@
+#pragma once
+#include "esphome/core/helpers.h"
+#include "frame_views.h"
+#include <cstring>
+#include <string>
+
+namespace esphome {
+namespace LD2412 {
+
+/*
+  All the gate energies of an engineering frame as one base64 string, for the gate_energies
+  text sensor. Bytes: gate count, moving energy of each gate, still energy of each gate,
+  light (0-255). 14 gates are 30 bytes, 40 characters without padding.
+*/
+static const size_t GATE_ENERGIES_SIZE = 1 + 2 * FRAME_GATES + 1;
+
+inline std::string encode_gate_energies(const uint8_t *moving_energies, const uint8_t *still_energies,
+                                        uint8_t light) {
+  uint8_t packed[GATE_ENERGIES_SIZE];
+  packed[0] = FRAME_GATES;
+  std::memcpy(packed + 1, moving_energies, FRAME_GATES);
+  std::memcpy(packed + 1 + FRAME_GATES, still_energies, FRAME_GATES);
+  packed[GATE_ENERGIES_SIZE - 1] = light;
+  return base64_encode(packed, sizeof(packed));
+}
+
+// For a device receiving the text sensor, false if the string is not a 14 gates vector
+inline bool decode_gate_energies(const std::string &encoded, uint8_t *moving_energies, uint8_t *still_energies,
+                                 uint8_t &light) {
+  std::vector<uint8_t> packed = base64_decode(encoded);
+  if (packed.size() != GATE_ENERGIES_SIZE || packed[0] != FRAME_GATES)
+    return false;
+  std::memcpy(moving_energies, packed.data() + 1, FRAME_GATES);
+  std::memcpy(still_energies, packed.data() + 1 + FRAME_GATES, FRAME_GATES);
+  light = packed[GATE_ENERGIES_SIZE - 1];
+  return true;
+}
+
+}  // namespace LD2412
+}  // namespace esphome
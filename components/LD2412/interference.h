@@ -0,0 +1,120 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_LD2412_INTERFERENCE
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+static const uint8_t INTERFERENCE_GATES = 14;
+// EWMA weight of a new sample, about the last 16 frames
+static const float INTERFERENCE_ALPHA = 1.0f / 16;
+// A gate spikes when its energy is this many standard deviations over its mean...
+static const float INTERFERENCE_SPIKE_SIGMA = 3.0f;
+// ...and at least this far from it, so quiet gates with a tiny variance do not spike on noise
+static const float INTERFERENCE_SPIKE_MIN_DELTA = 10.0f;
+// Samples needed before a gate baseline is trusted
+static const uint8_t INTERFERENCE_WARMUP_FRAMES = 16;
+// Consecutive spikes after which a gate is taken as having a new level
+static const uint8_t INTERFERENCE_SPIKE_RUN = 8;
+static const uint32_t INTERFERENCE_RATE_WINDOW_MS = 1000;
+
+/*
+  Streaming statistics of the moving gate energies. Everything is updated incrementally,
+  memory does not grow with the number of frames.
+
+  A target lights up a contiguous run of gates, while a co-located 24 GHz module shows
+  up as spikes scattered over non-adjacent gates. Frames whose spikes form two runs or
+  more are counted as interference, and interference is reported while their rate stays
+  over the threshold (with hysteresis at half of it).
+*/
+class InterferenceDetector {
+ public:
+  void set_threshold(float events_per_second) { this->threshold_ = events_per_second; }
+  float get_threshold() const { return this->threshold_; }
+
+  // Returns true when the detected state changed
+  bool add_frame(const uint8_t *moving_energies, uint32_t now) {
+    uint16_t spikes = 0;
+    for (uint8_t gate = 0; gate < INTERFERENCE_GATES; gate++) {
+      float delta = moving_energies[gate] - this->mean_[gate];
+      float limit = std::max(INTERFERENCE_SPIKE_SIGMA * std::sqrt(this->variance_[gate]), INTERFERENCE_SPIKE_MIN_DELTA);
+      if (this->samples_ >= INTERFERENCE_WARMUP_FRAMES && delta > limit) {
+        spikes |= 1 << gate;
+        // Isolated spikes are kept out of the baseline they are measured against,
+        // a gate that stays high is a change of level and is absorbed again
+        if (this->spike_run_[gate] < INTERFERENCE_SPIKE_RUN) {
+          this->spike_run_[gate]++;
+          this->gate_spike_rate_[gate] += INTERFERENCE_ALPHA * (1 - this->gate_spike_rate_[gate]);
+          continue;
+        }
+      } else {
+        this->spike_run_[gate] = 0;
+      }
+      // West's incremental update, mean and variance move together
+      float increment = INTERFERENCE_ALPHA * delta;
+      this->mean_[gate] += increment;
+      this->variance_[gate] = (1 - INTERFERENCE_ALPHA) * (this->variance_[gate] + delta * increment);
+      this->gate_spike_rate_[gate] += INTERFERENCE_ALPHA * (((spikes >> gate) & 1) - this->gate_spike_rate_[gate]);
+    }
+    if (this->samples_ < INTERFERENCE_WARMUP_FRAMES)
+      this->samples_++;
+    this->last_spikes_ = spikes;
+    // number of separate runs of spiking gates
+    if (__builtin_popcount(spikes & ~(spikes << 1)) >= 2)
+      this->window_events_++;
+    this->window_spikes_ += __builtin_popcount(spikes);
+    return this->update_rate_(now);
+  }
+
+  bool is_detected() const { return this->detected_; }
+  float gate_mean(uint8_t gate) const { return this->mean_[gate]; }
+  float gate_variance(uint8_t gate) const { return this->variance_[gate]; }
+  // Share of the recent frames where the gate spiked
+  float gate_spike_rate(uint8_t gate) const { return this->gate_spike_rate_[gate]; }
+  uint16_t last_spikes() const { return this->last_spikes_; }
+  // Spiking gates per second, all gates together
+  float spike_rate() const { return this->spike_rate_; }
+  // Interference frames per second
+  float event_rate() const { return this->event_rate_; }
+
+ protected:
+  bool update_rate_(uint32_t now) {
+    uint32_t elapsed = now - this->window_start_millis_;
+    if (elapsed < INTERFERENCE_RATE_WINDOW_MS)
+      return false;
+    float events = this->window_events_ * 1000.0f / elapsed;
+    float spikes = this->window_spikes_ * 1000.0f / elapsed;
+    // Smooth over about 4 windows
+    this->event_rate_ += (events - this->event_rate_) / 4;
+    this->spike_rate_ += (spikes - this->spike_rate_) / 4;
+    this->window_start_millis_ = now;
+    this->window_events_ = 0;
+    this->window_spikes_ = 0;
+    bool detected = this->detected_ ? this->event_rate_ >= this->threshold_ / 2 : this->event_rate_ >= this->threshold_;
+    if (detected == this->detected_)
+      return false;
+    this->detected_ = detected;
+    return true;
+  }
+
+  float mean_[INTERFERENCE_GATES]{};
+  float variance_[INTERFERENCE_GATES]{};
+  float gate_spike_rate_[INTERFERENCE_GATES]{};
+  uint8_t spike_run_[INTERFERENCE_GATES]{};
+  uint8_t samples_{0};
+  uint16_t last_spikes_{0};
+  uint32_t window_start_millis_{0};
+  uint16_t window_events_{0};
+  uint16_t window_spikes_{0};
+  float event_rate_{0};
+  float spike_rate_{0};
+  float threshold_{0.5f};
+  bool detected_{false};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
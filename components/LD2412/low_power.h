@@ -0,0 +1,77 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_LD2412_LOW_POWER
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+// Light sleep is not worth its entry and exit cost below this
+static const uint32_t LOW_POWER_MIN_SLEEP_US = 5000;
+// Frames are expected no closer than this to the learned interval
+static const float LOW_POWER_JITTER_SIGMA = 3.0f;
+
+enum WakeCause : uint8_t {
+  WAKE_TIMER,
+  WAKE_UART,
+  WAKE_PIN,
+  WAKE_OTHER,
+  WAKE_CAUSES,
+};
+
+/*
+  Light sleep planning between periodic frames. The UART does not receive while the SoC
+  sleeps and the bytes that wake it up are lost, so the sleep ends ahead of the next frame
+  by the guard time plus a few times the measured jitter. UART activity (an ACK, an early
+  frame) still wakes it up as a backstop.
+*/
+class SleepPlanner {
+ public:
+  void set_guard(uint32_t guard_us) { this->guard_us_ = guard_us; }
+  uint32_t get_guard() const { return this->guard_us_; }
+  void set_max_sleep(uint32_t max_sleep_us) { this->max_sleep_us_ = max_sleep_us; }
+  uint32_t get_max_sleep() const { return this->max_sleep_us_; }
+
+  // Sleep time in us before the next expected frame, 0 when too short to be worth it
+  uint32_t sleep_time(uint32_t now, uint32_t last_frame, float interval, float jitter) const {
+    if (interval <= 0)
+      return 0;
+    uint32_t early = this->guard_us_ + static_cast<uint32_t>(LOW_POWER_JITTER_SIGMA * jitter);
+    uint32_t since = now - last_frame;
+    if (since + early >= interval)
+      return 0;
+    uint32_t sleep = static_cast<uint32_t>(interval) - early - since;
+    if (sleep > this->max_sleep_us_)
+      sleep = this->max_sleep_us_;
+    return sleep >= LOW_POWER_MIN_SLEEP_US ? sleep : 0;
+  }
+
+  void add_sleep(uint32_t slept_us, WakeCause cause) {
+    this->slept_us_ += slept_us;
+    this->wakes_[cause]++;
+  }
+  // Sleep time and wake-ups since the last reset_window()
+  uint32_t slept() const { return this->slept_us_; }
+  uint32_t wakes() const {
+    uint32_t total = 0;
+    for (uint32_t wakes : this->wakes_)
+      total += wakes;
+    return total;
+  }
+  uint32_t wakes(WakeCause cause) const { return this->wakes_[cause]; }
+  void reset_window() {
+    this->slept_us_ = 0;
+    for (uint32_t &wakes : this->wakes_)
+      wakes = 0;
+  }
+
+ protected:
+  uint32_t guard_us_{3000};
+  uint32_t max_sleep_us_{1000000};
+  uint32_t slept_us_{0};
+  uint32_t wakes_[WAKE_CAUSES]{};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
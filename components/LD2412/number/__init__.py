@@ -17,7 +17,7 @@ from esphome.const import (
 from .. import CONF_LD2412_ID, LD2412Component, LD2412_ns
 
 GateThresholdNumber = LD2412_ns.class_("GateThresholdNumber", number.Number)
-# LightThresholdNumber = LD2412_ns.class_("LightThresholdNumber", number.Number)
+LightThresholdNumber = LD2412_ns.class_("LightThresholdNumber", number.Number)
 MaxDistanceTimeoutNumber = LD2412_ns.class_("MaxDistanceTimeoutNumber", number.Number)
 
 CONF_MIN_DISTANCE_GATE = "min_distance_gate"
@@ -49,12 +49,12 @@ CONFIG_SCHEMA = cv.Schema(
             entity_category=ENTITY_CATEGORY_CONFIG,
             icon=ICON_MOTION_SENSOR,
         ),
-        # cv.Optional(CONF_LIGHT_THRESHOLD): number.number_schema(
-        #     LightThresholdNumber,
-        #     device_class=DEVICE_CLASS_ILLUMINANCE,
-        #     entity_category=ENTITY_CATEGORY_CONFIG,
-        #     icon=ICON_LIGHTBULB,
-        # ),
+        cv.Optional(CONF_LIGHT_THRESHOLD): number.number_schema(
+            LightThresholdNumber,
+            device_class=DEVICE_CLASS_ILLUMINANCE,
+            entity_category=ENTITY_CATEGORY_CONFIG,
+            icon=ICON_LIGHTBULB,
+        ),
     }
 )
 # for x in range(14):
@@ -141,9 +141,9 @@ async def to_code(config):
             )
             await cg.register_parented(n, config[CONF_LD2412_ID])
             cg.add(LD2412_component.set_gate_still_threshold_number(x, n))
-    # if light_threshold_config := config.get(CONF_LIGHT_THRESHOLD):
-    #     n = await number.new_number(
-    #         light_threshold_config, min_value=0, max_value=255, step=1
-    #     )
-    #     await cg.register_parented(n, config[CONF_LD2412_ID])
-    #     cg.add(LD2412_component.set_light_threshold_number(n))
\ No newline at end of file
+    if light_threshold_config := config.get(CONF_LIGHT_THRESHOLD):
+        n = await number.new_number(
+            light_threshold_config, min_value=0, max_value=255, step=1
+        )
+        await cg.register_parented(n, config[CONF_LD2412_ID])
+        cg.add(LD2412_component.set_light_threshold_number(n))
\ No newline at end of file
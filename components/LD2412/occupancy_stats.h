@@ -0,0 +1,161 @@
+#pragma once
+#include "esphome/core/defines.h"
+#ifdef USE_LD2412_STATS
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+static const uint8_t STATS_GATES = 14;
+static const uint8_t STATS_HOURS = 24;
+static const uint32_t STATS_HOUR_MS = 3600000;
+// Longer gaps between frames (config mode, radar offline) are not counted
+static const uint32_t STATS_MAX_FRAME_GAP_MS = 1000;
+/*
+  Checkpoints are written to these slots in turn, so that a write cut by a power loss
+  leaves the previous one to restore. The slots do not level wear: the preferences sync
+  rewrites the ESP8266 flash sector whatever slot changed, and ESP32 NVS spreads its
+  writes over its own pages. Wear is bounded by the checkpoint interval instead: at the
+  default of 1h, 24 writes a day, about 8800 a year, keep a 100k erase cycle sector over
+  10 years even on ESP8266. At 15min it would be 35k a year.
+*/
+static const uint8_t STATS_SLOTS = 4;
+// Sensors and hour clock update
+static const uint32_t STATS_UPDATE_INTERVAL = 60000;
+// Checkpoints of another version are ignored, bump it when OccupancyData changes
+static const uint8_t STATS_VERSION = 1;
+
+/*
+  Statistics kept across reboots, in seconds. The milliseconds below the second are only
+  kept in RAM by OccupancyStats.
+*/
+struct OccupancyData {
+  // Checkpoint number, the slot holding the highest one is restored
+  uint32_t sequence;
+  uint8_t version;
+  // Index of the current hour in hours
+  uint8_t hour;
+  // Occupied seconds of the last 24 hours of uptime
+  uint16_t hours[STATS_HOURS];
+  uint32_t hour_elapsed_ms;
+  // Time covered by frames, and occupied part of it
+  uint32_t observed_seconds;
+  uint32_t occupied_seconds;
+  // Time each gate was active
+  uint32_t gate_seconds[STATS_GATES];
+};
+
+/*
+  Incremental occupancy statistics. add_frame() does a constant amount of work: the gap
+  with the previous frame is added to the occupied time and to each active gate, there is
+  no per-frame storage. Hours are hours of uptime, counted on from the checkpoint after a
+  reboot.
+*/
+class OccupancyStats {
+ public:
+  OccupancyStats() { this->clear(); }
+
+  void clear() {
+    this->data_ = OccupancyData{};
+    this->data_.version = STATS_VERSION;
+    this->dirty_ = true;
+  }
+  void restore(const OccupancyData &data) {
+    this->data_ = data;
+    this->dirty_ = false;
+  }
+  const OccupancyData &data() const { return this->data_; }
+
+  // Advances the hour clock, called with every frame and periodically
+  void advance(uint32_t now) {
+    if (!this->clock_started_) {
+      this->clock_started_ = true;
+      this->clock_millis_ = now;
+      return;
+    }
+    this->data_.hour_elapsed_ms += now - this->clock_millis_;
+    this->clock_millis_ = now;
+    if (this->data_.hour_elapsed_ms >= STATS_HOURS * STATS_HOUR_MS) {
+      // a whole day without the clock advancing
+      for (uint16_t &hour : this->data_.hours)
+        hour = 0;
+      this->data_.hour_elapsed_ms %= STATS_HOUR_MS;
+      this->hour_ms_ = 0;
+      this->dirty_ = true;
+    }
+    while (this->data_.hour_elapsed_ms >= STATS_HOUR_MS) {
+      this->data_.hour_elapsed_ms -= STATS_HOUR_MS;
+      this->data_.hour = (this->data_.hour + 1) % STATS_HOURS;
+      this->data_.hours[this->data_.hour] = 0;
+      this->hour_ms_ = 0;
+      this->dirty_ = true;
+    }
+  }
+
+  // active_gates: bit n set when gate n has activity
+  void add_frame(uint32_t now, bool occupied, uint16_t active_gates) {
+    uint32_t gap = now - this->frame_millis_;
+    bool first = !this->frame_seen_;
+    this->frame_millis_ = now;
+    this->frame_seen_ = true;
+    this->advance(now);
+    if (first || gap > STATS_MAX_FRAME_GAP_MS)
+      return;
+    add_time(this->observed_ms_, this->data_.observed_seconds, gap);
+    if (occupied) {
+      add_time(this->occupied_ms_, this->data_.occupied_seconds, gap);
+      add_time(this->hour_ms_, this->data_.hours[this->data_.hour], gap);
+    }
+    for (active_gates &= (1U << STATS_GATES) - 1; active_gates != 0; active_gates &= active_gates - 1) {
+      uint8_t gate = __builtin_ctz(active_gates);
+      add_time(this->gate_ms_[gate], this->data_.gate_seconds[gate], gap);
+    }
+    this->dirty_ = true;
+  }
+
+  // Changed since the last checkpoint
+  bool dirty() const { return this->dirty_; }
+  // Returns the data to save, numbered after the previous checkpoint
+  const OccupancyData &checkpoint() {
+    this->data_.sequence++;
+    this->dirty_ = false;
+    return this->data_;
+  }
+
+  // in seconds
+  uint16_t current_hour() const { return this->data_.hours[this->data_.hour]; }
+  uint16_t last_hour() const { return this->data_.hours[(this->data_.hour + STATS_HOURS - 1) % STATS_HOURS]; }
+  uint32_t last_day() const {
+    uint32_t total = 0;
+    for (uint16_t hour : this->data_.hours)
+      total += hour;
+    return total;
+  }
+  // index 0 is the oldest hour, STATS_HOURS - 1 the current one
+  uint16_t hour_at(uint8_t index) const { return this->data_.hours[(this->data_.hour + 1 + index) % STATS_HOURS]; }
+
+ protected:
+  // gap is at most STATS_MAX_FRAME_GAP_MS, the remainder carries at most once
+  template<typename T> static void add_time(uint16_t &ms, T &seconds, uint32_t gap) {
+    ms += gap;
+    if (ms >= 1000) {
+      ms -= 1000;
+      seconds++;
+    }
+  }
+
+  OccupancyData data_;
+  bool dirty_{false};
+  bool clock_started_{false};
+  uint32_t clock_millis_{0};
+  bool frame_seen_{false};
+  uint32_t frame_millis_{0};
+  uint16_t observed_ms_{0};
+  uint16_t occupied_ms_{0};
+  uint16_t hour_ms_{0};
+  uint16_t gate_ms_[STATS_GATES]{};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+#endif
@@ -0,0 +1,196 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+#ifdef USE_LD2412_PUBLISH_BUDGET
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#endif
+
+namespace esphome {
+namespace LD2412 {
+
+// Order in which pending publishes are sent when the budget runs out
+enum PublishPriority : uint8_t {
+  // target, zone occupancy and OUT pin binary sensors
+  PUBLISH_PRESENCE = 0,
+  // target distances and energies
+  PUBLISH_DISTANCE = 1,
+  // gate and zone energies, light, loop and interference statistics
+  PUBLISH_DIAGNOSTIC = 2,
+};
+static const uint8_t PUBLISH_PRIORITIES = 3;
+
+#ifdef USE_LD2412_PUBLISH_BUDGET
+/*
+  Spreads the publishes of one frame over several loop passes. Values are queued per entity,
+  a new value for an entity still waiting replaces the old one (coalesced) instead of being
+  published twice. Every loop pass sends queued values by priority, then by age, until the
+  per loop budget or the per second budget (a token bucket) is spent; what is left waits for
+  the next pass (deferred).
+*/
+class PublishScheduler {
+ public:
+  using PublishFunction = void (*)(void *entity, float value);
+
+  void set_loop_budget(uint16_t budget) { this->loop_budget_ = budget; }
+  // 0: no per second limit
+  void set_second_budget(uint16_t budget) {
+    this->second_budget_ = budget;
+    this->tokens_ = budget;
+  }
+  uint16_t get_loop_budget() const { return this->loop_budget_; }
+  uint16_t get_second_budget() const { return this->second_budget_; }
+
+  void publish(void *entity, float value, PublishPriority priority, PublishFunction function) {
+    Slot &slot = this->slots_[this->slot_index_(entity, priority, function)];
+    if (slot.pending) {
+      this->coalesced_++;
+      slot.value = value;
+      return;
+    }
+    this->enqueue_(slot, value);
+  }
+
+  // Same as publish, skipping values equal to the current state of the entity once queued values are accounted for
+  void publish_changed(void *entity, float value, float current, PublishPriority priority, PublishFunction function) {
+    Slot &slot = this->slots_[this->slot_index_(entity, priority, function)];
+    if (slot.pending) {
+      this->coalesced_++;
+      // Back to the published state: the queued value is dropped, its queue entry is skipped
+      if (same_value(value, current))
+        slot.pending = false;
+      slot.value = value;
+      return;
+    }
+    if (!same_value(value, current))
+      this->enqueue_(slot, value);
+  }
+
+  void run(uint32_t now) {
+    this->refill_(now);
+    uint16_t budget = this->loop_budget_;
+    for (uint8_t priority = 0; priority < PUBLISH_PRIORITIES; priority++) {
+      std::vector<uint8_t> &queue = this->queues_[priority];
+      size_t &head = this->heads_[priority];
+      while (head < queue.size()) {
+        if (budget == 0 || (this->second_budget_ != 0 && this->tokens_ == 0)) {
+          this->defer_();
+          return;
+        }
+        Slot &slot = this->slots_[queue[head++]];
+        if (!slot.pending)
+          continue;
+        slot.pending = false;
+        budget--;
+        if (this->tokens_ != 0)
+          this->tokens_--;
+        this->published_++;
+        // The entity callbacks may queue new values, do not keep references across the call
+        void *entity = slot.entity;
+        PublishFunction function = slot.function;
+        function(entity, slot.value);
+      }
+      queue.clear();
+      head = 0;
+    }
+  }
+
+  bool has_pending() const {
+    for (uint8_t priority = 0; priority < PUBLISH_PRIORITIES; priority++) {
+      if (this->heads_[priority] < this->queues_[priority].size())
+        return true;
+    }
+    return false;
+  }
+  uint32_t published() const { return this->published_; }
+  // values not sent in the loop pass that queued them
+  uint32_t deferred() const { return this->deferred_; }
+  // values replaced by a newer one before being sent
+  uint32_t coalesced() const { return this->coalesced_; }
+
+  static bool same_value(float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+ protected:
+  struct Slot {
+    void *entity;
+    PublishFunction function;
+    float value;
+    PublishPriority priority;
+    bool pending;
+    // already counted in deferred_
+    bool deferred;
+  };
+
+  // Slots are created on the first publish of an entity and looked up by address
+  uint8_t slot_index_(void *entity, PublishPriority priority, PublishFunction function) {
+    auto it = std::lower_bound(this->index_.begin(), this->index_.end(), entity,
+                               [](const std::pair<void *, uint8_t> &entry, void *key) { return entry.first < key; });
+    if (it != this->index_.end() && it->first == entity)
+      return it->second;
+    uint8_t index = this->slots_.size();
+    this->slots_.push_back({entity, function, 0, priority, false, false});
+    this->index_.insert(it, {entity, index});
+    return index;
+  }
+
+  void enqueue_(Slot &slot, float value) {
+    slot.value = value;
+    slot.pending = true;
+    slot.deferred = false;
+    this->queues_[slot.priority].push_back(&slot - this->slots_.data());
+  }
+
+  void refill_(uint32_t now) {
+    if (this->second_budget_ == 0)
+      return;
+    uint32_t elapsed = now - this->refill_millis_;
+    if (elapsed >= 1000) {
+      this->tokens_ = this->second_budget_;
+      this->refill_millis_ = now;
+      return;
+    }
+    uint32_t added = elapsed * this->second_budget_ / 1000;
+    if (added == 0)
+      return;
+    this->tokens_ = std::min<uint32_t>(this->tokens_ + added, this->second_budget_);
+    // Keep the remainder for the next pass
+    this->refill_millis_ += added * 1000 / this->second_budget_;
+  }
+
+  void defer_() {
+    for (uint8_t priority = 0; priority < PUBLISH_PRIORITIES; priority++) {
+      std::vector<uint8_t> &queue = this->queues_[priority];
+      size_t &head = this->heads_[priority];
+      for (size_t i = head; i < queue.size(); i++) {
+        Slot &slot = this->slots_[queue[i]];
+        if (slot.pending && !slot.deferred) {
+          slot.deferred = true;
+          this->deferred_++;
+        }
+      }
+      queue.erase(queue.begin(), queue.begin() + head);
+      head = 0;
+    }
+  }
+
+  std::vector<Slot> slots_;
+  // (entity, slot) sorted by entity
+  std::vector<std::pair<void *, uint8_t>> index_;
+  // slots waiting per priority, in queuing order from heads_
+  std::vector<uint8_t> queues_[PUBLISH_PRIORITIES];
+  size_t heads_[PUBLISH_PRIORITIES]{};
+  uint16_t loop_budget_{8};
+  uint16_t second_budget_{0};
+  uint32_t tokens_{0};
+  uint32_t refill_millis_{0};
+  uint32_t published_{0};
+  uint32_t deferred_{0};
+  uint32_t coalesced_{0};
+};
+#endif
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -5,7 +5,7 @@ namespace LD2412 {
 
 void LightOutControlSelect::control(const std::string &value) {
   this->publish_state(value);
-  this->parent_->set_basic_config();
+  this->parent_->set_light_out_control();
 }
 
 }  // namespace LD2412
@@ -13,8 +13,32 @@ from esphome.const import (
     ICON_MOTION_SENSOR,
     ICON_LIGHTBULB,
     UNIT_LUX,
+    UNIT_HERTZ,
+    UNIT_MICROSECOND,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
+    UNIT_MINUTE,
+    UNIT_HOUR,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    ICON_COUNTER,
+    ICON_TIMER,
+)
+from . import (
+    CONF_LD2412_ID,
+    CONF_ZONES,
+    CONF_START_GATE,
+    CONF_END_GATE,
+    MAX_ZONES,
+    LD2412Component,
+    AckError,
+    validate_zone_gates,
+    require_hub_option,
+    CONF_WATCHDOG,
+    CONF_STATS,
+    CONF_LOW_POWER,
+    CONF_COMMAND_STATS,
 )
-from . import CONF_LD2412_ID, LD2412Component
 
 DEPENDENCIES = ["LD2412"]
 CONF_MOVING_DISTANCE = "moving_distance"
@@ -23,6 +47,47 @@ CONF_MOVING_ENERGY = "moving_energy"
 CONF_STILL_ENERGY = "still_energy"
 CONF_DETECTION_DISTANCE = "detection_distance"
 CONF_MOVE_ENERGY = "move_energy"
+CONF_LOOP_RATE = "loop_rate"
+CONF_PARSER_TIME = "parser_time"
+CONF_DROPPED_FRAMES = "dropped_frames"
+CONF_FRAME_JITTER = "frame_jitter"
+CONF_FRAME_INTERVAL = "frame_interval"
+CONF_FRAME_INTERVAL_MIN = "frame_interval_min"
+CONF_FRAME_INTERVAL_MAX = "frame_interval_max"
+CONF_SPIKE_RATE = "spike_rate"
+CONF_RECOVERY_ATTEMPTS = "recovery_attempts"
+CONF_RECOVERIES = "recoveries"
+CONF_DEFERRED_PUBLISHES = "deferred_publishes"
+CONF_COALESCED_PUBLISHES = "coalesced_publishes"
+CONF_BACKGROUND_CORRECTION_PROGRESS = "background_correction_progress"
+CONF_BACKGROUND_CORRECTION_REMAINING = "background_correction_remaining"
+CONF_OCCUPANCY_LAST_HOUR = "occupancy_last_hour"
+CONF_OCCUPANCY_LAST_DAY = "occupancy_last_day"
+CONF_OCCUPANCY_TOTAL = "occupancy_total"
+CONF_WAKEUPS = "wakeups"
+CONF_AWAKE_TIME = "awake_time"
+CONF_COMMAND_LATENCY = "command_latency"
+CONF_COMMAND_LATENCY_MAX = "command_latency_max"
+ACK_ERROR_SENSORS = {
+    "ack_timeouts": AckError.ACK_TIMEOUT,
+    "ack_bad_headers": AckError.ACK_BAD_HEADER,
+    "ack_bad_statuses": AckError.ACK_BAD_STATUS,
+    "ack_nonzero_results": AckError.ACK_NONZERO_RESULT,
+    "ack_truncated": AckError.ACK_TRUNCATED,
+}
+
+ZONE_SCHEMA = cv.All(
+    sensor.sensor_schema(
+        unit_of_measurement=UNIT_PERCENT,
+        icon=ICON_MOTION_SENSOR,
+    ).extend(
+        {
+            cv.Required(CONF_START_GATE): cv.int_range(min=0, max=13),
+            cv.Required(CONF_END_GATE): cv.int_range(min=0, max=13),
+        }
+    ),
+    validate_zone_gates,
+)
 
 CONFIG_SCHEMA = cv.Schema(
     {
@@ -55,6 +120,160 @@ CONFIG_SCHEMA = cv.Schema(
             unit_of_measurement=UNIT_CENTIMETER,
             icon=ICON_SIGNAL,
         ),
+        cv.Optional(CONF_LOOP_RATE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_HERTZ,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_PARSER_TIME): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MICROSECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_DROPPED_FRAMES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_FRAME_JITTER): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_FRAME_INTERVAL): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        # shortest and longest interval in the last second
+        cv.Optional(CONF_FRAME_INTERVAL_MIN): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_FRAME_INTERVAL_MAX): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_SPIKE_RATE): sensor.sensor_schema(
+            unit_of_measurement="spikes/s",
+            accuracy_decimals=2,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_SIGNAL,
+        ),
+        cv.Optional(CONF_RECOVERY_ATTEMPTS): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_RECOVERIES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_DEFERRED_PUBLISHES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_COALESCED_PUBLISHES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_BACKGROUND_CORRECTION_PROGRESS): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=0,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_BACKGROUND_CORRECTION_REMAINING): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=0,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_COMMAND_LATENCY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_COMMAND_LATENCY_MAX): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        # need low_power on the hub
+        cv.Optional(CONF_WAKEUPS): sensor.sensor_schema(
+            unit_of_measurement="wakeups/min",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        ),
+        cv.Optional(CONF_AWAKE_TIME): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_OCCUPANCY_LAST_HOUR): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MINUTE,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_OCCUPANCY_LAST_DAY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MINUTE,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_OCCUPANCY_TOTAL): sensor.sensor_schema(
+            unit_of_measurement=UNIT_HOUR,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            icon=ICON_TIMER,
+        ),
+        cv.Optional(CONF_ZONES): cv.All(
+            cv.ensure_list(ZONE_SCHEMA), cv.Length(min=1, max=MAX_ZONES)
+        ),
+    }
+)
+
+CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
+    {
+        cv.Optional(key): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            icon=ICON_COUNTER,
+        )
+        for key in ACK_ERROR_SENSORS
     }
 )
 
@@ -102,8 +321,113 @@ async def to_code(config):
     for x in range(14):
         if gate_conf := config.get(f"g{x}"):
             if move_config := gate_conf.get(CONF_MOVE_ENERGY):
+                cg.add_define("USE_LD2412_GATE_SENSORS")
                 sens = await sensor.new_sensor(move_config)
                 cg.add(LD2412_component.set_gate_move_sensor(x, sens))
             if still_config := gate_conf.get(CONF_STILL_ENERGY):
+                cg.add_define("USE_LD2412_GATE_SENSORS")
                 sens = await sensor.new_sensor(still_config)
                 cg.add(LD2412_component.set_gate_still_sensor(x, sens))
+    if loop_rate_config := config.get(CONF_LOOP_RATE):
+        cg.add_define("USE_LD2412_LOOP_STATS")
+        sens = await sensor.new_sensor(loop_rate_config)
+        cg.add(LD2412_component.set_loop_rate_sensor(sens))
+    if parser_time_config := config.get(CONF_PARSER_TIME):
+        cg.add_define("USE_LD2412_LOOP_STATS")
+        sens = await sensor.new_sensor(parser_time_config)
+        cg.add(LD2412_component.set_parser_time_sensor(sens))
+    if dropped_frames_config := config.get(CONF_DROPPED_FRAMES):
+        cg.add_define("USE_LD2412_LOOP_STATS")
+        sens = await sensor.new_sensor(dropped_frames_config)
+        cg.add(LD2412_component.set_dropped_frames_sensor(sens))
+    if frame_jitter_config := config.get(CONF_FRAME_JITTER):
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        sens = await sensor.new_sensor(frame_jitter_config)
+        cg.add(LD2412_component.set_frame_jitter_sensor(sens))
+    if frame_interval_config := config.get(CONF_FRAME_INTERVAL):
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        sens = await sensor.new_sensor(frame_interval_config)
+        cg.add(LD2412_component.set_frame_interval_sensor(sens))
+    if frame_interval_min_config := config.get(CONF_FRAME_INTERVAL_MIN):
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        sens = await sensor.new_sensor(frame_interval_min_config)
+        cg.add(LD2412_component.set_frame_interval_min_sensor(sens))
+    if frame_interval_max_config := config.get(CONF_FRAME_INTERVAL_MAX):
+        cg.add_define("USE_LD2412_FRAME_TIMING")
+        sens = await sensor.new_sensor(frame_interval_max_config)
+        cg.add(LD2412_component.set_frame_interval_max_sensor(sens))
+    if spike_rate_config := config.get(CONF_SPIKE_RATE):
+        cg.add_define("USE_LD2412_INTERFERENCE")
+        sens = await sensor.new_sensor(spike_rate_config)
+        cg.add(LD2412_component.set_spike_rate_sensor(sens))
+    if recovery_attempts_config := config.get(CONF_RECOVERY_ATTEMPTS):
+        require_hub_option(
+            CONF_RECOVERY_ATTEMPTS, config[CONF_LD2412_ID], CONF_WATCHDOG
+        )
+        sens = await sensor.new_sensor(recovery_attempts_config)
+        cg.add(LD2412_component.set_recovery_attempts_sensor(sens))
+    if recoveries_config := config.get(CONF_RECOVERIES):
+        require_hub_option(CONF_RECOVERIES, config[CONF_LD2412_ID], CONF_WATCHDOG)
+        sens = await sensor.new_sensor(recoveries_config)
+        cg.add(LD2412_component.set_recoveries_sensor(sens))
+    if deferred_publishes_config := config.get(CONF_DEFERRED_PUBLISHES):
+        cg.add_define("USE_LD2412_PUBLISH_BUDGET")
+        sens = await sensor.new_sensor(deferred_publishes_config)
+        cg.add(LD2412_component.set_deferred_publishes_sensor(sens))
+    if coalesced_publishes_config := config.get(CONF_COALESCED_PUBLISHES):
+        cg.add_define("USE_LD2412_PUBLISH_BUDGET")
+        sens = await sensor.new_sensor(coalesced_publishes_config)
+        cg.add(LD2412_component.set_coalesced_publishes_sensor(sens))
+    if progress_config := config.get(CONF_BACKGROUND_CORRECTION_PROGRESS):
+        cg.add_define("USE_LD2412_BACKGROUND_CORRECTION")
+        sens = await sensor.new_sensor(progress_config)
+        cg.add(LD2412_component.set_background_correction_progress_sensor(sens))
+    if remaining_config := config.get(CONF_BACKGROUND_CORRECTION_REMAINING):
+        cg.add_define("USE_LD2412_BACKGROUND_CORRECTION")
+        sens = await sensor.new_sensor(remaining_config)
+        cg.add(LD2412_component.set_background_correction_remaining_sensor(sens))
+    if latency_config := config.get(CONF_COMMAND_LATENCY):
+        require_hub_option(
+            CONF_COMMAND_LATENCY, config[CONF_LD2412_ID], CONF_COMMAND_STATS
+        )
+        sens = await sensor.new_sensor(latency_config)
+        cg.add(LD2412_component.set_command_latency_sensor(sens))
+    if latency_max_config := config.get(CONF_COMMAND_LATENCY_MAX):
+        require_hub_option(
+            CONF_COMMAND_LATENCY_MAX, config[CONF_LD2412_ID], CONF_COMMAND_STATS
+        )
+        sens = await sensor.new_sensor(latency_max_config)
+        cg.add(LD2412_component.set_command_latency_max_sensor(sens))
+    for key, error in ACK_ERROR_SENSORS.items():
+        if error_config := config.get(key):
+            require_hub_option(key, config[CONF_LD2412_ID], CONF_COMMAND_STATS)
+            sens = await sensor.new_sensor(error_config)
+            cg.add(LD2412_component.set_ack_error_sensor(error, sens))
+    if wakeups_config := config.get(CONF_WAKEUPS):
+        require_hub_option(CONF_WAKEUPS, config[CONF_LD2412_ID], CONF_LOW_POWER)
+        sens = await sensor.new_sensor(wakeups_config)
+        cg.add(LD2412_component.set_wakeups_sensor(sens))
+    if awake_time_config := config.get(CONF_AWAKE_TIME):
+        require_hub_option(CONF_AWAKE_TIME, config[CONF_LD2412_ID], CONF_LOW_POWER)
+        sens = await sensor.new_sensor(awake_time_config)
+        cg.add(LD2412_component.set_awake_time_sensor(sens))
+    for key in (CONF_OCCUPANCY_LAST_HOUR, CONF_OCCUPANCY_LAST_DAY, CONF_OCCUPANCY_TOTAL):
+        if key in config:
+            require_hub_option(key, config[CONF_LD2412_ID], CONF_STATS)
+    if last_hour_config := config.get(CONF_OCCUPANCY_LAST_HOUR):
+        sens = await sensor.new_sensor(last_hour_config)
+        cg.add(LD2412_component.set_occupancy_last_hour_sensor(sens))
+    if last_day_config := config.get(CONF_OCCUPANCY_LAST_DAY):
+        sens = await sensor.new_sensor(last_day_config)
+        cg.add(LD2412_component.set_occupancy_last_day_sensor(sens))
+    if total_config := config.get(CONF_OCCUPANCY_TOTAL):
+        sens = await sensor.new_sensor(total_config)
+        cg.add(LD2412_component.set_occupancy_total_sensor(sens))
+    for zone_config in config.get(CONF_ZONES, []):
+        cg.add_define("USE_LD2412_ZONE_ENERGY")
+        sens = await sensor.new_sensor(zone_config)
+        cg.add(
+            LD2412_component.add_zone_energy_sensor(
+                zone_config[CONF_START_GATE], zone_config[CONF_END_GATE], sens
+            )
+        )
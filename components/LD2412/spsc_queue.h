@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace esphome {
+namespace LD2412 {
+
+/*
+  Lock-free ring for exactly one producer and one consumer, possibly on different cores.
+  Items are written and read in place: the producer fills the slot returned by
+  producer_slot() then calls push(), the consumer reads front() then calls pop().
+  N must be a power of two, one slot is never used to tell full from empty.
+*/
+template<typename T, size_t N> class SPSCQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCQueue size must be a power of two");
+
+ public:
+  // nullptr when full
+  T *producer_slot() {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    if (((head + 1) & (N - 1)) == this->tail_.load(std::memory_order_acquire))
+      return nullptr;
+    return &this->items_[head];
+  }
+  void push() {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    this->head_.store((head + 1) & (N - 1), std::memory_order_release);
+  }
+
+  // nullptr when empty
+  T *front() {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->head_.load(std::memory_order_acquire))
+      return nullptr;
+    return &this->items_[tail];
+  }
+  void pop() {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    this->tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+  }
+
+  static constexpr size_t capacity() { return N - 1; }
+
+ protected:
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+  T items_[N];
+};
+
+}  // namespace LD2412
+}  // namespace esphome
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace LD2412 {
+
+// Gates held by a GateVector, one per byte
+static const uint8_t GATE_VECTOR_GATES = 14;
+static const uint16_t ALL_GATES = (1 << GATE_VECTOR_GATES) - 1;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Byte n of a word is gate n, which the bitmask gathering below relies on
+#define LD2412_SWAR
+#endif
+
+/*
+  The energies of the 14 gates of a frame, compared and reduced a 64-bit word at a time
+  (SWAR: gates 0-7 in one word, 8-13 and two zero bytes in the other). Results over gates
+  are bitmasks, bit n for gate n. Each operation also has a byte loop, used on big endian
+  targets and by the host benchmark (tools/bench_swar.cpp).
+*/
+class GateVector {
+ public:
+  static GateVector load(const uint8_t *gates) {
+    GateVector v;
+    std::memcpy(v.bytes_, gates, GATE_VECTOR_GATES);
+    return v;
+  }
+  static GateVector fill(uint8_t value) {
+    GateVector v;
+#ifdef LD2412_SWAR
+    v.set_word_(0, broadcast_(value));
+    v.set_word_(1, broadcast_(value) & PADDING_CLEAR);
+#else
+    std::memset(v.bytes_, value, GATE_VECTOR_GATES);
+#endif
+    return v;
+  }
+  // 0xFF in the gates of the mask, for masked()
+  static GateVector from_mask(uint16_t gates) {
+    GateVector v;
+    for (uint8_t gate = 0; gate < GATE_VECTOR_GATES; gate++)
+      v.bytes_[gate] = (gates >> gate) & 1 ? 0xFF : 0x00;
+    return v;
+  }
+
+  uint8_t operator[](uint8_t gate) const { return this->bytes_[gate]; }
+
+  // Gates where this energy is at least the threshold
+  uint16_t at_least(const GateVector &thresholds) const {
+#ifdef LD2412_SWAR
+    return (gather_(at_least_(this->word_(0), thresholds.word_(0))) |
+            gather_(at_least_(this->word_(1), thresholds.word_(1))) << 8) &
+           ALL_GATES;
+#else
+    return this->at_least_scalar(thresholds);
+#endif
+  }
+  // Gates whose energy differs from other
+  uint16_t differs(const GateVector &other) const {
+#ifdef LD2412_SWAR
+    return gather_(nonzero_(this->word_(0) ^ other.word_(0))) |
+           gather_(nonzero_(this->word_(1) ^ other.word_(1))) << 8;
+#else
+    return this->differs_scalar(other);
+#endif
+  }
+  // Gate by gate maximum
+  GateVector max(const GateVector &other) const {
+#ifdef LD2412_SWAR
+    GateVector v;
+    v.set_word_(0, max_(this->word_(0), other.word_(0)));
+    v.set_word_(1, max_(this->word_(1), other.word_(1)));
+    return v;
+#else
+    return this->max_scalar(other);
+#endif
+  }
+  GateVector masked(const GateVector &byte_mask) const {
+    GateVector v;
+    v.set_word_(0, this->word_(0) & byte_mask.word_(0));
+    v.set_word_(1, this->word_(1) & byte_mask.word_(1));
+    return v;
+  }
+  uint8_t max_value() const {
+#ifdef LD2412_SWAR
+    uint64_t m = max_(this->word_(0), this->word_(1));
+    m = max_(m, m >> 32);
+    m = max_(m, m >> 16);
+    m = max_(m, m >> 8);
+    return m & 0xFF;
+#else
+    return this->max_value_scalar();
+#endif
+  }
+  // First gate holding the highest energy
+  uint8_t max_gate() const {
+#ifdef LD2412_SWAR
+    uint64_t value = broadcast_(this->max_value());
+    uint16_t equal = ~(gather_(nonzero_(this->word_(0) ^ value)) | gather_(nonzero_(this->word_(1) ^ value)) << 8);
+    return __builtin_ctz(equal);
+#else
+    return this->max_gate_scalar();
+#endif
+  }
+
+  uint16_t at_least_scalar(const GateVector &thresholds) const {
+    uint16_t mask = 0;
+    for (uint8_t gate = 0; gate < GATE_VECTOR_GATES; gate++)
+      mask |= (this->bytes_[gate] >= thresholds.bytes_[gate]) << gate;
+    return mask;
+  }
+  uint16_t differs_scalar(const GateVector &other) const {
+    uint16_t mask = 0;
+    for (uint8_t gate = 0; gate < GATE_VECTOR_GATES; gate++)
+      mask |= (this->bytes_[gate] != other.bytes_[gate]) << gate;
+    return mask;
+  }
+  GateVector max_scalar(const GateVector &other) const {
+    GateVector v;
+    for (uint8_t gate = 0; gate < GATE_VECTOR_GATES; gate++)
+      v.bytes_[gate] = this->bytes_[gate] > other.bytes_[gate] ? this->bytes_[gate] : other.bytes_[gate];
+    return v;
+  }
+  uint8_t max_value_scalar() const { return this->bytes_[this->max_gate_scalar()]; }
+  uint8_t max_gate_scalar() const {
+    uint8_t best = 0;
+    for (uint8_t gate = 1; gate < GATE_VECTOR_GATES; gate++) {
+      if (this->bytes_[gate] > this->bytes_[best])
+        best = gate;
+    }
+    return best;
+  }
+
+ protected:
+  static constexpr uint64_t LOW_BITS = 0x0101010101010101ULL;
+  static constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+  // keeps gates 8-13 of the second word
+  static constexpr uint64_t PADDING_CLEAR = 0x0000FFFFFFFFFFFFULL;
+
+  uint64_t word_(uint8_t index) const {
+    uint64_t word;
+    std::memcpy(&word, this->bytes_ + 8 * index, sizeof(word));
+    return word;
+  }
+  void set_word_(uint8_t index, uint64_t word) { std::memcpy(this->bytes_ + 8 * index, &word, sizeof(word)); }
+
+  static uint64_t broadcast_(uint8_t value) { return LOW_BITS * value; }
+  // High bit of each byte where a >= b: compare the low 7 bits without borrows, then the high bits
+  static uint64_t at_least_(uint64_t a, uint64_t b) {
+    uint64_t low = (a | HIGH_BITS) - (b & ~HIGH_BITS);
+    return ((a & ~b) | (~(a ^ b) & low)) & HIGH_BITS;
+  }
+  // High bit of each non zero byte
+  static uint64_t nonzero_(uint64_t x) { return (((x & ~HIGH_BITS) + ~HIGH_BITS) | x) & HIGH_BITS; }
+  static uint64_t max_(uint64_t a, uint64_t b) {
+    // 0xFF where a >= b
+    uint64_t select = (at_least_(a, b) >> 7) * 0xFF;
+    return (a & select) | (b & ~select);
+  }
+  // High bit of byte n to bit n, the multiply moves all 8 of them into the top byte
+  static uint16_t gather_(uint64_t high_bits) { return ((high_bits >> 7) * 0x0102040810204080ULL) >> 56; }
+
+  // 14 gates, the 2 bytes after them stay 0
+  alignas(8) uint8_t bytes_[16]{};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
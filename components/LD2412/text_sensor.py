@@ -7,10 +7,14 @@ from esphome.const import (
     CONF_MAC_ADDRESS,
     ICON_BLUETOOTH,
     ICON_CHIP,
+    ICON_RULER,
+    ICON_SIGNAL,
 )
 from . import CONF_LD2412_ID, LD2412Component
 
 DEPENDENCIES = ["LD2412"]
+CONF_GATE_RANGES = "gate_ranges"
+CONF_GATE_ENERGIES = "gate_energies"
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_LD2412_ID): cv.use_id(LD2412Component),
@@ -20,6 +24,12 @@ CONFIG_SCHEMA = {
     cv.Optional(CONF_MAC_ADDRESS): text_sensor.text_sensor_schema(
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon=ICON_BLUETOOTH
     ),
+    cv.Optional(CONF_GATE_RANGES): text_sensor.text_sensor_schema(
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon=ICON_RULER
+    ),
+    cv.Optional(CONF_GATE_ENERGIES): text_sensor.text_sensor_schema(
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC, icon=ICON_SIGNAL
+    ),
 }
 
 
@@ -31,3 +41,9 @@ async def to_code(config):
     if mac_address_config := config.get(CONF_MAC_ADDRESS):
         sens = await text_sensor.new_text_sensor(mac_address_config)
         cg.add(LD2412_component.set_mac_text_sensor(sens))
+    if gate_ranges_config := config.get(CONF_GATE_RANGES):
+        sens = await text_sensor.new_text_sensor(gate_ranges_config)
+        cg.add(LD2412_component.set_gate_ranges_text_sensor(sens))
+    if gate_energies_config := config.get(CONF_GATE_ENERGIES):
+        sens = await text_sensor.new_text_sensor(gate_energies_config)
+        cg.add(LD2412_component.set_gate_energies_text_sensor(sens))
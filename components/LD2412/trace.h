@@ -0,0 +1,104 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+namespace esphome {
+namespace LD2412 {
+
+enum TraceEventType : uint8_t {
+  // arg: command, value: value length. Config mode is entered and left by CMD_ENABLE_CONF / CMD_DISABLE_CONF
+  TRACE_COMMAND,
+  // the blocking wait of send_command_ after writing, arg: command
+  TRACE_COMMAND_WAIT_BEGIN,
+  TRACE_COMMAND_WAIT_END,
+  // arg: command | low byte of the result << 8, value: status
+  TRACE_ACK,
+  // dated with the frame footer arrival, arg: length, value: data type
+  TRACE_FRAME_RECEIVED,
+  // decoding of a periodic frame, arg: length, value: data type
+  TRACE_FRAME_BEGIN,
+  TRACE_FRAME_END,
+  // arg: PublishPriority, value: 0 sensor, 1 binary sensor
+  TRACE_PUBLISH,
+  TRACE_EVENT_TYPES,
+};
+
+static const char *const TRACE_EVENT_NAMES[TRACE_EVENT_TYPES] = {
+    "command", "wait_begin", "wait_end", "ack", "frame_received", "frame_begin", "frame_end", "publish",
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+
+#ifdef USE_LD2412_TRACE
+#include <cstddef>
+#include <vector>
+
+namespace esphome {
+namespace LD2412 {
+
+struct TraceEvent {
+  // micros()
+  uint32_t timestamp;
+  uint16_t arg;
+  uint8_t type;
+  uint8_t value;
+};
+static_assert(sizeof(TraceEvent) == 8, "TraceEvent must stay 8 bytes");
+
+/*
+  Ring of the last trace events, overwritten oldest first. Recording is an increment and one
+  8 byte store, without lock or atomic operation: events are only recorded and dumped from the
+  loop. Frames assembled by the RX task are recorded when the loop decodes them, dated with
+  their footer arrival.
+*/
+class TraceRing {
+ public:
+  // Rounded up to a power of two
+  void init(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    this->events_.resize(size);
+    this->mask_ = size - 1;
+  }
+  size_t capacity() const { return this->events_.size(); }
+
+  void record(uint32_t timestamp, TraceEventType type, uint16_t arg, uint8_t value) {
+    if (this->events_.empty())
+      return;
+    this->events_[this->next_++ & this->mask_] = TraceEvent{timestamp, arg, type, value};
+  }
+
+  size_t size() const { return this->next_ < this->events_.size() ? this->next_ : this->events_.size(); }
+  // index 0 is the oldest event
+  const TraceEvent &at(size_t index) const {
+    return this->events_[(this->next_ - this->size() + index) & this->mask_];
+  }
+  // Events overwritten since the start
+  uint32_t lost() const {
+    uint32_t next = this->next_;
+    return next > this->events_.size() ? next - this->events_.size() : 0;
+  }
+
+ protected:
+  std::vector<TraceEvent> events_;
+  size_t mask_{0};
+  // events recorded since the start
+  uint32_t next_{0};
+};
+
+}  // namespace LD2412
+}  // namespace esphome
+
+#define LD2412_TRACE(type, arg, value) this->trace_.record(micros(), (type), (arg), (value))
+#define LD2412_TRACE_AT(timestamp, type, arg, value) this->trace_.record((timestamp), (type), (arg), (value))
+#else
+// Compiled out
+#define LD2412_TRACE(type, arg, value) \
+  do { \
+  } while (0)
+#define LD2412_TRACE_AT(timestamp, type, arg, value) \
+  do { \
+  } while (0)
+#endif
@@ -0,0 +1,144 @@
+#include "LD2412_group.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace LD2412_group {
+
+static const char *const TAG = "LD2412_group";
+
+void LD2412GroupComponent::add_radar(LD2412::LD2412Component *radar) {
+  if (this->radars_.size() >= MAX_RADARS) {
+    ESP_LOGE(TAG, "Too many radars in the group, max is %u", MAX_RADARS);
+    return;
+  }
+  RadarState state{};
+  state.radar = radar;
+  this->radars_.push_back(state);
+}
+
+#ifdef USE_SENSOR
+void LD2412GroupComponent::set_radar_confidence_sensor(uint8_t index, sensor::Sensor *s) {
+  if (index >= this->radars_.size()) {
+    ESP_LOGE(TAG, "No radar %u in the group for the confidence sensor", index);
+    return;
+  }
+  this->radars_[index].confidence_sensor = s;
+}
+#endif
+
+void LD2412GroupComponent::setup() {
+  for (uint8_t i = 0; i < this->radars_.size(); i++) {
+    this->radars_[i].radar->add_on_frame_callback(
+        [this, i](const LD2412::PeriodicFrameView &frame) { this->handle_frame_(i, frame); });
+  }
+}
+
+void LD2412GroupComponent::dump_config() {
+  ESP_LOGCONFIG(TAG, "LD2412 group:");
+  ESP_LOGCONFIG(TAG, "  Radars: %u", (unsigned) this->radars_.size());
+  ESP_LOGCONFIG(TAG, "  Presence: %s", this->presence_mode_ == PRESENCE_MODE_MAJORITY ? "majority" : "any");
+  ESP_LOGCONFIG(TAG, "  Timeout: %ums", this->timeout_);
+  ESP_LOGCONFIG(TAG, "  Throttle: %ums", this->throttle_);
+#ifdef USE_BINARY_SENSOR
+  LOG_BINARY_SENSOR("  ", "TargetBinarySensor", this->target_binary_sensor_);
+  LOG_BINARY_SENSOR("  ", "MovingTargetBinarySensor", this->moving_target_binary_sensor_);
+  LOG_BINARY_SENSOR("  ", "StillTargetBinarySensor", this->still_target_binary_sensor_);
+#endif
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "DetectionDistanceSensor", this->detection_distance_sensor_);
+  LOG_SENSOR("  ", "ConfidenceSensor", this->confidence_sensor_);
+  for (auto &state : this->radars_) {
+    LOG_SENSOR("  ", "RadarConfidenceSensor", state.confidence_sensor);
+  }
+#endif
+}
+
+void LD2412GroupComponent::handle_frame_(uint8_t index, const LD2412::PeriodicFrameView &frame) {
+  uint32_t now = millis();
+  RadarState &state = this->radars_[index];
+  state.last_frame_millis = now;
+  state.online = true;
+  state.moving = frame.has_moving_target();
+  state.still = frame.has_still_target();
+  state.distance = frame.detection_distance();
+  state.energy = std::max(state.moving ? frame.moving_energy() : 0, state.still ? frame.still_energy() : 0);
+  this->fuse_(now);
+  // Re-armed by every frame, runs only once all radars are silent, to take them offline.
+  // set_timeout(uint32_t) of the group hides the scheduler one.
+  this->Component::set_timeout("offline", this->timeout_ + 1, [this]() { this->fuse_(millis()); });
+}
+
+bool LD2412GroupComponent::vote_(uint8_t count, uint8_t online) const {
+  if (this->presence_mode_ == PRESENCE_MODE_MAJORITY)
+    return count * 2 > online;
+  return count > 0;
+}
+
+void LD2412GroupComponent::fuse_(uint32_t now) {
+  uint8_t online = 0;
+  uint8_t targets = 0;
+  uint8_t moving = 0;
+  uint8_t still = 0;
+  uint16_t nearest = 0;
+  for (uint8_t i = 0; i < this->radars_.size(); i++) {
+    RadarState &state = this->radars_[i];
+    if (state.online && now - state.last_frame_millis > this->timeout_) {
+      ESP_LOGW(TAG, "Radar %u stopped reporting, leaving it out of the group", i);
+      state.online = false;
+#ifdef USE_SENSOR
+      if (state.confidence_sensor != nullptr)
+        state.confidence_sensor->publish_state(NAN);
+#endif
+    }
+    if (!state.online)
+      continue;
+    online++;
+    if (state.moving)
+      moving++;
+    if (state.still)
+      still++;
+    if (state.moving || state.still) {
+      targets++;
+      if (nearest == 0 || (state.distance != 0 && state.distance < nearest))
+        nearest = state.distance;
+    }
+  }
+  bool has_target = this->vote_(targets, online);
+
+  /*
+    Presence is published as soon as it changes, values that move with every frame are throttled
+  */
+#ifdef USE_BINARY_SENSOR
+  if (this->target_binary_sensor_ != nullptr)
+    this->target_binary_sensor_->publish_state(has_target);
+  if (this->moving_target_binary_sensor_ != nullptr)
+    this->moving_target_binary_sensor_->publish_state(this->vote_(moving, online));
+  if (this->still_target_binary_sensor_ != nullptr)
+    this->still_target_binary_sensor_->publish_state(this->vote_(still, online));
+#endif
+  if (now - this->last_publish_millis_ < this->throttle_)
+    return;
+  this->last_publish_millis_ = now;
+#ifdef USE_SENSOR
+  if (this->detection_distance_sensor_ != nullptr) {
+    int new_distance = has_target ? nearest : 0;
+    if (this->detection_distance_sensor_->get_state() != new_distance)
+      this->detection_distance_sensor_->publish_state(new_distance);
+  }
+  if (this->confidence_sensor_ != nullptr) {
+    // share of the online radars that see a target
+    int new_confidence = online == 0 ? 0 : (targets * 100) / online;
+    if (this->confidence_sensor_->get_state() != new_confidence)
+      this->confidence_sensor_->publish_state(new_confidence);
+  }
+  for (auto &state : this->radars_) {
+    if (state.confidence_sensor != nullptr && state.online && state.confidence_sensor->get_state() != state.energy)
+      state.confidence_sensor->publish_state(state.energy);
+  }
+#endif
+}
+
+}  // namespace LD2412_group
+}  // namespace esphome
@@ -0,0 +1,83 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include "esphome/core/component.h"
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+#include "../LD2412/LD2412.h"
+
+#include <vector>
+
+namespace esphome {
+namespace LD2412_group {
+
+static const uint8_t MAX_RADARS = 8;
+
+/*
+  PRESENCE_MODE_ANY: the space is occupied as soon as one radar sees a target
+  PRESENCE_MODE_MAJORITY: more than half of the online radars must see a target
+*/
+enum PresenceMode : uint8_t { PRESENCE_MODE_ANY = 0, PRESENCE_MODE_MAJORITY = 1 };
+
+// Last frame received from one radar of the group
+struct RadarState {
+  LD2412::LD2412Component *radar;
+  uint32_t last_frame_millis{0};
+  bool online{false};
+  bool moving{false};
+  bool still{false};
+  uint16_t distance{0};
+  // strongest energy of the reported targets, 0 without target
+  uint8_t energy{0};
+#ifdef USE_SENSOR
+  sensor::Sensor *confidence_sensor{nullptr};
+#endif
+};
+
+/*
+  Fuses the frames of several LD2412 watching the same space into one sensor set.
+  Fusion runs from the radars frame callbacks, there is no polling: a radar that
+  has not sent a frame for `timeout` is ignored the next time any radar reports,
+  or by a one-shot timeout re-armed on each frame when none of them reports any more.
+*/
+class LD2412GroupComponent : public Component {
+#ifdef USE_SENSOR
+  SUB_SENSOR(detection_distance)
+  SUB_SENSOR(confidence)
+#endif
+#ifdef USE_BINARY_SENSOR
+  SUB_BINARY_SENSOR(target)
+  SUB_BINARY_SENSOR(moving_target)
+  SUB_BINARY_SENSOR(still_target)
+#endif
+
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void add_radar(LD2412::LD2412Component *radar);
+  void set_presence_mode(PresenceMode presence_mode) { this->presence_mode_ = presence_mode; }
+  void set_timeout(uint32_t timeout) { this->timeout_ = timeout; }
+  void set_throttle(uint32_t throttle) { this->throttle_ = throttle; }
+#ifdef USE_SENSOR
+  void set_radar_confidence_sensor(uint8_t index, sensor::Sensor *s);
+#endif
+
+ protected:
+  void handle_frame_(uint8_t index, const LD2412::PeriodicFrameView &frame);
+  void fuse_(uint32_t now);
+  bool vote_(uint8_t count, uint8_t online) const;
+
+  std::vector<RadarState> radars_;
+  PresenceMode presence_mode_{PRESENCE_MODE_ANY};
+  uint32_t timeout_{2000};
+  uint32_t throttle_{1000};
+  uint32_t last_publish_millis_{0};
+};
+
+}  // namespace LD2412_group
+}  // namespace esphome
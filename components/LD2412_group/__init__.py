@@ -0,0 +1,58 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+    CONF_THROTTLE,
+    CONF_TIMEOUT,
+)
+from ..LD2412 import LD2412Component
+
+DEPENDENCIES = ["LD2412"]
+MULTI_CONF = True
+
+LD2412_group_ns = cg.esphome_ns.namespace("LD2412_group")
+LD2412GroupComponent = LD2412_group_ns.class_("LD2412GroupComponent", cg.Component)
+
+CONF_LD2412_GROUP_ID = "LD2412_group_id"
+CONF_RADARS = "radars"
+CONF_PRESENCE = "presence"
+
+MAX_RADARS = 8
+
+PresenceMode = LD2412_group_ns.enum("PresenceMode")
+PRESENCE_MODES = {
+    "any": PresenceMode.PRESENCE_MODE_ANY,
+    "majority": PresenceMode.PRESENCE_MODE_MAJORITY,
+}
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(LD2412GroupComponent),
+        cv.Required(CONF_RADARS): cv.All(
+            cv.ensure_list(cv.use_id(LD2412Component)),
+            cv.Length(min=2, max=MAX_RADARS),
+        ),
+        cv.Optional(CONF_PRESENCE, default="any"): cv.enum(PRESENCE_MODES, lower=True),
+        cv.Optional(CONF_TIMEOUT, default="2s"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=100)),
+        ),
+        cv.Optional(CONF_THROTTLE, default="1000ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=1)),
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    # fused from the on_frame callback of every radar
+    cg.add_define("USE_LD2412_ON_FRAME")
+    for radar_id in config[CONF_RADARS]:
+        radar = await cg.get_variable(radar_id)
+        cg.add(var.add_radar(radar))
+    cg.add(var.set_presence_mode(config[CONF_PRESENCE]))
+    cg.add(var.set_timeout(config[CONF_TIMEOUT]))
+    cg.add(var.set_throttle(config[CONF_THROTTLE]))
@@ -0,0 +1,44 @@
+import esphome.codegen as cg
+from esphome.components import binary_sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    DEVICE_CLASS_MOTION,
+    DEVICE_CLASS_OCCUPANCY,
+    ICON_MOTION_SENSOR,
+    ICON_ACCOUNT,
+    CONF_HAS_TARGET,
+    CONF_HAS_MOVING_TARGET,
+    CONF_HAS_STILL_TARGET,
+)
+from . import CONF_LD2412_GROUP_ID, LD2412GroupComponent
+
+DEPENDENCIES = ["LD2412_group"]
+
+CONFIG_SCHEMA = {
+    cv.GenerateID(CONF_LD2412_GROUP_ID): cv.use_id(LD2412GroupComponent),
+    cv.Optional(CONF_HAS_TARGET): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY,
+        icon=ICON_ACCOUNT,
+    ),
+    cv.Optional(CONF_HAS_MOVING_TARGET): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_MOTION,
+        icon=ICON_MOTION_SENSOR,
+    ),
+    cv.Optional(CONF_HAS_STILL_TARGET): binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY,
+        icon=ICON_MOTION_SENSOR,
+    ),
+}
+
+
+async def to_code(config):
+    group = await cg.get_variable(config[CONF_LD2412_GROUP_ID])
+    if has_target_config := config.get(CONF_HAS_TARGET):
+        sens = await binary_sensor.new_binary_sensor(has_target_config)
+        cg.add(group.set_target_binary_sensor(sens))
+    if has_moving_target_config := config.get(CONF_HAS_MOVING_TARGET):
+        sens = await binary_sensor.new_binary_sensor(has_moving_target_config)
+        cg.add(group.set_moving_target_binary_sensor(sens))
+    if has_still_target_config := config.get(CONF_HAS_STILL_TARGET):
+        sens = await binary_sensor.new_binary_sensor(has_still_target_config)
+        cg.add(group.set_still_target_binary_sensor(sens))
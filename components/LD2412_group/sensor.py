@@ -0,0 +1,53 @@
+import esphome.codegen as cg
+from esphome.components import sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    DEVICE_CLASS_DISTANCE,
+    UNIT_CENTIMETER,
+    UNIT_PERCENT,
+    ICON_SIGNAL,
+    ICON_ACCOUNT,
+)
+from . import CONF_LD2412_GROUP_ID, MAX_RADARS, LD2412GroupComponent
+
+DEPENDENCIES = ["LD2412_group"]
+CONF_DETECTION_DISTANCE = "detection_distance"
+CONF_CONFIDENCE = "confidence"
+CONF_RADAR_CONFIDENCE = "radar_confidence"
+
+CONFIDENCE_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_PERCENT,
+    accuracy_decimals=0,
+    icon=ICON_ACCOUNT,
+)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_LD2412_GROUP_ID): cv.use_id(LD2412GroupComponent),
+        cv.Optional(CONF_DETECTION_DISTANCE): sensor.sensor_schema(
+            device_class=DEVICE_CLASS_DISTANCE,
+            unit_of_measurement=UNIT_CENTIMETER,
+            icon=ICON_SIGNAL,
+        ),
+        cv.Optional(CONF_CONFIDENCE): CONFIDENCE_SCHEMA,
+        # one entry per radar, in the order of the group 'radars' list
+        cv.Optional(CONF_RADAR_CONFIDENCE): cv.All(
+            cv.ensure_list(CONFIDENCE_SCHEMA), cv.Length(min=1, max=MAX_RADARS)
+        ),
+    }
+)
+
+
+async def to_code(config):
+    group = await cg.get_variable(config[CONF_LD2412_GROUP_ID])
+    if detection_distance_config := config.get(CONF_DETECTION_DISTANCE):
+        sens = await sensor.new_sensor(detection_distance_config)
+        cg.add(group.set_detection_distance_sensor(sens))
+    if confidence_config := config.get(CONF_CONFIDENCE):
+        sens = await sensor.new_sensor(confidence_config)
+        cg.add(group.set_confidence_sensor(sens))
+    for index, radar_confidence_config in enumerate(
+        config.get(CONF_RADAR_CONFIDENCE, [])
+    ):
+        sens = await sensor.new_sensor(radar_confidence_config)
+        cg.add(group.set_radar_confidence_sensor(index, sens))
@@ -0,0 +1,97 @@
+/*
+  Host benchmark of the gate kernels of swar.h against their byte loops.
+
+    g++ -O2 -std=gnu++17 -I components/LD2412 tools/bench_swar.cpp -o /tmp/bench_swar
+    /tmp/bench_swar
+
+  Both versions are first checked to agree on random frames (full byte range included),
+  then timed over the same frames. Times are per frame of 14 gates.
+*/
+#include "swar.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace esphome::LD2412;
+
+namespace {
+
+const size_t FRAMES = 4096;
+const uint32_t ROUNDS = 2000;
+
+volatile uint32_t sink;
+
+template<typename F> double nanoseconds_per_frame(F &&body) {
+  auto start = std::chrono::steady_clock::now();
+  uint32_t acc = 0;
+  for (uint32_t round = 0; round < ROUNDS; round++) {
+    for (size_t i = 0; i < FRAMES; i++)
+      acc += body(i);
+  }
+  sink = acc;
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (double(ROUNDS) * FRAMES);
+}
+
+void report(const char *name, double scalar, double swar) {
+  std::printf("%-28s scalar %6.2f ns  swar %6.2f ns  x%.1f\n", name, scalar, swar, scalar / swar);
+}
+
+}  // namespace
+
+int main() {
+#ifndef LD2412_SWAR
+  std::printf("Big endian host: GateVector uses the byte loops, nothing to compare\n");
+  return 0;
+#endif
+  std::mt19937 rng(1);
+  std::vector<GateVector> moving, still;
+  uint8_t bytes[GATE_VECTOR_GATES];
+  for (size_t i = 0; i < FRAMES; i++) {
+    // a quarter of the frames use the full byte range, the others the 0-100 energies of the module
+    uint32_t range = i % 4 == 0 ? 256 : 101;
+    for (auto &b : bytes)
+      b = rng() % range;
+    moving.push_back(GateVector::load(bytes));
+    for (auto &b : bytes)
+      b = rng() % range;
+    still.push_back(GateVector::load(bytes));
+  }
+  const GateVector threshold = GateVector::fill(40);
+  const GateVector zone = GateVector::from_mask(0x00F0);
+
+  size_t errors = 0;
+  for (size_t i = 0; i < FRAMES; i++) {
+    const GateVector &a = moving[i], &b = still[i], &previous = moving[(i + 1) % FRAMES];
+    errors += a.at_least(threshold) != a.at_least_scalar(threshold);
+    errors += a.at_least(b) != a.at_least_scalar(b);
+    errors += a.differs(previous) != a.differs_scalar(previous);
+    errors += a.max_gate() != a.max_gate_scalar();
+    errors += a.max(b).masked(zone).max_value() != a.max_scalar(b).masked(zone).max_value_scalar();
+  }
+  if (errors != 0) {
+    std::printf("%zu mismatches between the SWAR and scalar kernels\n", errors);
+    return 1;
+  }
+
+  report("gates at least threshold",
+         nanoseconds_per_frame([&](size_t i) { return moving[i].at_least_scalar(threshold); }),
+         nanoseconds_per_frame([&](size_t i) { return moving[i].at_least(threshold); }));
+  report("gates changed",
+         nanoseconds_per_frame([&](size_t i) { return moving[i].differs_scalar(moving[(i + 1) % FRAMES]); }),
+         nanoseconds_per_frame([&](size_t i) { return moving[i].differs(moving[(i + 1) % FRAMES]); }));
+  report("strongest gate", nanoseconds_per_frame([&](size_t i) { return moving[i].max_gate_scalar(); }),
+         nanoseconds_per_frame([&](size_t i) { return moving[i].max_gate(); }));
+  report("zone energy (max, mask, max)",
+         nanoseconds_per_frame([&](size_t i) { return moving[i].max_scalar(still[i]).masked(zone).max_value_scalar(); }),
+         nanoseconds_per_frame([&](size_t i) { return moving[i].max(still[i]).masked(zone).max_value(); }));
+  report("zone occupancy (move|still)",
+         nanoseconds_per_frame([&](size_t i) {
+           return (moving[i].at_least_scalar(threshold) | still[i].at_least_scalar(threshold)) & 0x00F0;
+         }),
+         nanoseconds_per_frame(
+             [&](size_t i) { return (moving[i].at_least(threshold) | still[i].at_least(threshold)) & 0x00F0; }));
+  return 0;
+}
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Flash and RAM footprint of the LD2412 component in the reference configurations.
+
+Each configuration of this directory is compiled with esphome, then measured from its
+firmware.elf with the size tool of the PlatformIO toolchain:
+
+- flash: code and constants written to flash, minus the same for base.yaml (no LD2412)
+- ram: static RAM (.data, .rodata on ESP8266, .bss), minus base.yaml
+- instance: sizeof(LD2412Component), read with the toolchain gdb. The component is
+  allocated on the heap at boot, once per radar.
+
+    tools/footprint/footprint.py                  # compile, measure, check budget.json
+    tools/footprint/footprint.py --no-compile     # measure the last builds
+    tools/footprint/footprint.py --update         # record the current numbers as budget
+
+The run fails when a number exceeds its budget, or when budget.json (or the entry of
+a configuration) is missing, so that a check without budget does not pass. Budgets are recorded with a margin
+(--margin, in %) so that toolchain noise does not fail it, and are only meaningful
+for the esphome version they were recorded with, printed at the top of budget.json.
+"""
+
+import argparse
+import glob
+import json
+import math
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BUDGET = os.path.join(HERE, "budget.json")
+BASE = "base"
+CONFIGS = ["presence", "normal", "engineering", "multi"]
+INSTANCE_TYPE = "esphome::LD2412::LD2412Component"
+
+# Sections stored in flash, ESP8266 and ESP32 names
+FLASH_SECTIONS = {
+    ".irom0.text",
+    ".text",
+    ".text1",
+    ".data",
+    ".rodata",
+    ".flash.text",
+    ".flash.rodata",
+    ".flash.appdesc",
+    ".iram0.text",
+    ".iram0.vectors",
+    ".dram0.data",
+}
+# Sections taking RAM from boot. .rodata is copied to RAM on ESP8266 only.
+RAM_SECTIONS = {
+    "esp8266": {".data", ".rodata", ".bss"},
+    "esp32": {".dram0.data", ".dram0.bss", ".noinit"},
+}
+
+
+def platform_of(config):
+    with open(os.path.join(HERE, "common.yaml"), encoding="utf-8") as file:
+        common = file.read()
+    with open(os.path.join(HERE, config + ".yaml"), encoding="utf-8") as file:
+        text = common + file.read()
+    return "esp32" if re.search(r"^esp32:", text, re.M) else "esp8266"
+
+
+def node_name(config):
+    with open(os.path.join(HERE, config + ".yaml"), encoding="utf-8") as file:
+        match = re.search(r"^\s+name:\s*(\S+)", file.read(), re.M)
+    return match.group(1)
+
+
+def compile_config(config):
+    print(f"Compiling {config}.yaml", file=sys.stderr)
+    result = subprocess.run(
+        ["esphome", "compile", config + ".yaml"], cwd=HERE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True
+    )
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout[-4000:])
+        sys.exit(f"{config}.yaml does not compile")
+
+
+def firmware(config):
+    name = node_name(config)
+    path = os.path.join(HERE, ".esphome", "build", name, ".pioenvs", name, "firmware.elf")
+    if not os.path.exists(path):
+        sys.exit(f"{path} not found, compile {config}.yaml first")
+    return path
+
+
+def toolchain(tool, platform):
+    """Returns the path of a toolchain binary (size, gdb) of PlatformIO for the platform."""
+    prefix = "xtensa-lx106-elf-" if platform == "esp8266" else "xtensa-esp32-elf-"
+    found = shutil.which(prefix + tool)
+    if found:
+        return found
+    packages = os.environ.get("PLATFORMIO_CORE_DIR", os.path.expanduser("~/.platformio"))
+    for path in sorted(glob.glob(os.path.join(packages, "packages", "toolchain-*", "bin", prefix + tool))):
+        return path
+    return None
+
+
+def sections(elf, platform):
+    size = toolchain("size", platform)
+    if size is None:
+        sys.exit(f"No size tool found for {platform}")
+    output = subprocess.run([size, "-A", elf], stdout=subprocess.PIPE, text=True, check=True).stdout
+    result = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            result[fields[0]] = int(fields[1])
+    return result
+
+
+def instance_size(elf, platform):
+    gdb = toolchain("gdb", platform)
+    if gdb is None:
+        return None
+    result = subprocess.run(
+        [gdb, "-batch", "-ex", f"print sizeof({INSTANCE_TYPE})", elf],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL,
+        text=True,
+    )
+    match = re.search(r"= (\d+)", result.stdout)
+    return int(match.group(1)) if match else None
+
+
+def measure(config):
+    platform = platform_of(config)
+    elf = firmware(config)
+    sizes = sections(elf, platform)
+    return {
+        "flash": sum(size for name, size in sizes.items() if name in FLASH_SECTIONS),
+        "ram": sum(size for name, size in sizes.items() if name in RAM_SECTIONS[platform]),
+        "instance": instance_size(elf, platform) if config != BASE else None,
+    }
+
+
+def esphome_version():
+    try:
+        return subprocess.run(["esphome", "version"], stdout=subprocess.PIPE, text=True).stdout.strip()
+    except OSError:
+        return "unknown"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("configs", nargs="*", default=CONFIGS, help="configurations to measure, all by default")
+    parser.add_argument("--no-compile", action="store_true", help="measure the existing builds")
+    parser.add_argument("--update", action="store_true", help="write the current numbers to budget.json")
+    parser.add_argument("--margin", type=float, default=2, help="margin added to the budget by --update, in %%")
+    args = parser.parse_args()
+
+    if not args.no_compile:
+        for config in [BASE] + args.configs:
+            compile_config(config)
+    base = measure(BASE)
+    results = {}
+    for config in args.configs:
+        numbers = measure(config)
+        numbers["flash"] -= base["flash"]
+        numbers["ram"] -= base["ram"]
+        results[config] = numbers
+
+    budget = {}
+    if os.path.exists(BUDGET):
+        with open(BUDGET, encoding="utf-8") as file:
+            budget = json.load(file)
+    print(f"{'config':<12} {'flash':>8} {'ram':>8} {'instance':>9}   budget (flash/ram/instance)")
+    failures = []
+    for config, numbers in results.items():
+        limits = budget.get("configs", {}).get(config, {})
+        instance = "?" if numbers["instance"] is None else numbers["instance"]
+        shown = "/".join(str(limits.get(key, "-")) for key in ("flash", "ram", "instance"))
+        print(f"{config:<12} {numbers['flash']:>8} {numbers['ram']:>8} {instance:>9}   {shown}")
+        if not limits and not args.update:
+            failures.append(f"{config}: no budget")
+        for key, value in numbers.items():
+            if value is not None and key in limits and value > limits[key]:
+                failures.append(f"{config}: {key} {value} > {limits[key]} (+{value - limits[key]})")
+
+    if args.update:
+        configs = budget.setdefault("configs", {})
+        for config, numbers in results.items():
+            configs[config] = {
+                key: math.ceil(value * (1 + args.margin / 100)) for key, value in numbers.items() if value is not None
+            }
+        budget["esphome"] = esphome_version()
+        with open(BUDGET, "w", encoding="utf-8") as file:
+            json.dump(budget, file, indent=2, sort_keys=True)
+            file.write("\n")
+        print(f"Budget written to {BUDGET}", file=sys.stderr)
+        return
+    if not budget:
+        sys.exit("No budget.json, run with --update to record one")
+    if failures:
+        print("Over budget or without budget:\n  " + "\n  ".join(failures), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
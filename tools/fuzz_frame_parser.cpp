@@ -0,0 +1,226 @@
+/*
+  Fuzz driver of the UART frame parser (frame_parser.h), the state machine behind
+  LD2412Component::readline_.
+
+  Random inputs, with the sanitizers of gcc or clang:
+
+    g++ -O1 -g -std=gnu++17 -fsanitize=address,undefined -I components/LD2412 tools/fuzz_frame_parser.cpp -o /tmp/fuzz_frame_parser
+    /tmp/fuzz_frame_parser [iterations] [seed]
+
+  libFuzzer (clang only), each input is one byte stream:
+
+    clang++ -O1 -g -std=gnu++17 -fsanitize=fuzzer,address,undefined -DLD2412_LIBFUZZER -I components/LD2412 tools/fuzz_frame_parser.cpp -o /tmp/fuzz_frame_parser
+    /tmp/fuzz_frame_parser -max_len=1024
+
+  Every frame the parser returns must fit the buffer, start with a header, end with the
+  frame end bytes of that header and match its length field. One stream in 16 of the random
+  driver is random bytes, the others are built from valid periodic frames and ACKs:
+  - clean: every frame is returned, unchanged, when its last byte is read
+  - truncated: frames cut short, with the next frames following right away
+  - over-long: frames with extra bytes, or with a length field beyond the buffer
+  - noise: random bytes before a frame
+  A fault can hide the frames that follow it within MAX_FRAME_LENGTH bytes, as a cut frame
+  takes its bytes from the next ones. Every valid frame starting after that must be
+  returned, the parser must have resynced. A frame cut inside its header hides nothing.
+*/
+#include "frame_parser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace esphome::LD2412;
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+void check(bool condition, const char *what, const uint8_t *data, size_t size) {
+  if (condition)
+    return;
+  std::fprintf(stderr, "Check failed: %s, frame of %zu bytes:", what, size);
+  for (size_t i = 0; i < size; i++)
+    std::fprintf(stderr, " %02X", data[i]);
+  std::fprintf(stderr, "\n");
+  std::abort();
+}
+
+// Runs the parser over a stream and checks the frames it returns
+void parse(const uint8_t *data, size_t size) {
+  FrameParser parser;
+  // exact size, so that writes past the end are reported
+  Bytes buffer(MAX_FRAME_LENGTH);
+  for (size_t i = 0; i < size; i++) {
+    int len = parser.feed(data[i], buffer.data(), buffer.size());
+    check(parser.position() < MAX_FRAME_LENGTH, "parser position beyond the buffer", buffer.data(), buffer.size());
+    if (len <= 0)
+      continue;
+    const uint8_t *frame = buffer.data();
+    check(len <= MAX_FRAME_LENGTH && len >= int(sizeof(FrameHeader) + FRAME_FOOTER_SIZE), "frame length", frame, len);
+    bool data_frame = memcmp(frame, DATA_FRAME_HEADER, 4) == 0;
+    check(data_frame || memcmp(frame, CMD_FRAME_HEADER, 4) == 0, "frame header", frame, len);
+    check(memcmp(frame + len - FRAME_FOOTER_SIZE, data_frame ? DATA_FRAME_END : CMD_FRAME_END, 4) == 0,
+          "frame end bytes", frame, len);
+    check(FrameParser::frame_length(frame) == len, "length field", frame, len);
+  }
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  parse(data, size);
+  return 0;
+}
+
+#ifndef LD2412_LIBFUZZER
+namespace {
+
+enum Fault { FAULT_NONE, FAULT_TRUNCATED, FAULT_OVER_LONG, FAULT_NOISE, FAULTS };
+const char *const FAULT_NAMES[FAULTS] = {"clean", "truncated", "over-long", "noise"};
+
+Bytes frame(std::mt19937 &rng) {
+  Bytes frame;
+  bool ack = rng() % 4 == 0;
+  const uint8_t *header = ack ? CMD_FRAME_HEADER : DATA_FRAME_HEADER;
+  const uint8_t *footer = ack ? CMD_FRAME_END : DATA_FRAME_END;
+  size_t payload;
+  if (ack) {
+    // command, status, result and up to 14 values (gate sensitivities)
+    payload = 4 + rng() % 15;
+  } else {
+    payload = rng() % 2 ? sizeof(EngineeringFrame) - sizeof(FrameHeader) + rng() % 2
+                        : sizeof(PeriodicFrame) - sizeof(FrameHeader);
+    payload += sizeof(PeriodicFrameTail);
+  }
+  frame.insert(frame.end(), header, header + 4);
+  frame.push_back(payload & 0xFF);
+  frame.push_back(payload >> 8);
+  for (size_t i = 0; i < payload; i++) {
+    // values of the module, with frame end bytes inside now and then, as in a MAC
+    uint8_t value = rng() % 101;
+    if (rng() % 32 == 0)
+      value = footer[rng() % 4];
+    frame.push_back(value);
+  }
+  frame.insert(frame.end(), footer, footer + 4);
+  return frame;
+}
+
+struct Sent {
+  Bytes frame;
+  // offset of the end of the frame in the stream
+  size_t end;
+  // far enough from the last fault that the parser must have resynced
+  bool required;
+};
+
+struct Totals {
+  uint64_t streams{0};
+  uint64_t bytes{0};
+  uint64_t sent{0};
+  uint64_t received{0};
+  uint64_t faults{0};
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::mt19937 rng(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1);
+  Totals totals[FAULTS];
+  uint64_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    Bytes stream;
+    if (i % 16 == 15) {
+      // random bytes, with header bytes more often than chance
+      stream.resize(rng() % 1024);
+      for (auto &b : stream) {
+        uint32_t r = rng() % 16;
+        b = r == 0 ? DATA_FRAME_HEADER[rng() % 4] : r == 1 ? CMD_FRAME_HEADER[rng() % 4] : rng();
+      }
+      bytes += stream.size();
+      LLVMFuzzerTestOneInput(stream.data(), stream.size());
+      continue;
+    }
+    Fault fault = Fault(i % FAULTS);
+    std::vector<Sent> sent;
+    Totals &t = totals[fault];
+    // a fault can hide the frames in the longest frame after it
+    size_t resync = 0;
+    for (uint32_t n = 1 + rng() % 12; n > 0; n--) {
+      Bytes f = frame(rng);
+      bool valid = true;
+      if (fault != FAULT_NONE && rng() % 3 == 0) {
+        t.faults++;
+        size_t hidden = stream.size() + MAX_FRAME_LENGTH;
+        switch (fault) {
+          case FAULT_TRUNCATED:
+            // a quarter are cut inside the header, the next header must still be found
+            f.resize(rng() % 4 == 0 ? 1 + rng() % 3 : 1 + rng() % (f.size() - 1));
+            if (f.size() < sizeof(FrameHeader::header))
+              hidden = 0;
+            valid = false;
+            break;
+          case FAULT_OVER_LONG:
+            if (rng() % 2) {
+              // length field beyond the buffer
+              uint16_t length = MAX_FRAME_LENGTH + rng() % 1024;
+              f[4] = length & 0xFF;
+              f[5] = length >> 8;
+            } else {
+              f.insert(f.begin() + 6 + rng() % (f.size() - 6), 1 + rng() % 8, 0x42);
+            }
+            valid = false;
+            break;
+          default:
+            for (uint32_t noise = 1 + rng() % 32; noise > 0; noise--)
+              stream.push_back(rng());
+            break;
+        }
+        resync = std::max(resync, hidden);
+      }
+      stream.insert(stream.end(), f.begin(), f.end());
+      if (valid)
+        sent.push_back({f, stream.size(), stream.size() - f.size() >= resync});
+    }
+
+    // frames received, by end offset
+    std::vector<Bytes> received(stream.size() + 1);
+    FrameParser parser;
+    Bytes buffer(MAX_FRAME_LENGTH);
+    for (size_t pos = 0; pos < stream.size(); pos++) {
+      int len = parser.feed(stream[pos], buffer.data(), buffer.size());
+      if (len > 0)
+        received[pos + 1].assign(buffer.begin(), buffer.begin() + len);
+    }
+    LLVMFuzzerTestOneInput(stream.data(), stream.size());
+    bytes += stream.size();
+    t.streams++;
+    t.bytes += stream.size();
+    t.sent += sent.size();
+    for (const Sent &s : sent) {
+      bool ok = received[s.end] == s.frame;
+      t.received += ok;
+      if (!ok && (fault == FAULT_NONE || s.required)) {
+        std::fprintf(stderr, "%s stream of %zu bytes: frame ending at %zu not received\n", FAULT_NAMES[fault],
+                     stream.size(), s.end);
+        return 1;
+      }
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (uint8_t fault = 0; fault < FAULTS; fault++) {
+    const Totals &t = totals[fault];
+    std::printf("%-10s %8llu streams, %6.2f%% of %llu valid frames received, %llu faults\n", FAULT_NAMES[fault],
+                (unsigned long long) t.streams, t.sent == 0 ? 100.0 : 100.0 * t.received / t.sent,
+                (unsigned long long) t.sent, (unsigned long long) t.faults);
+  }
+  std::printf("%llu streams, %.1f MB, %.0f exec/s, %.1f MB/s\n", (unsigned long long) iterations, bytes / 1e6,
+              iterations / seconds, bytes / 1e6 / seconds);
+  return 0;
+}
+#endif
@@ -0,0 +1,176 @@
+/*
+  Fuzz driver of the frame views of frame_views.h: frame_cast and PeriodicFrameView are fed
+  arbitrary buffers, allocated at their exact size so that any read past the end is caught
+  by AddressSanitizer.
+
+  Random inputs, with the sanitizers of gcc or clang:
+
+    g++ -O1 -g -std=gnu++17 -fsanitize=address,undefined -I components/LD2412 tools/fuzz_frame_views.cpp -o /tmp/fuzz_frame_views
+    /tmp/fuzz_frame_views [iterations] [seed]
+
+  libFuzzer (clang only):
+
+    clang++ -O1 -g -std=gnu++17 -fsanitize=fuzzer,address,undefined -DLD2412_LIBFUZZER -I components/LD2412 tools/fuzz_frame_views.cpp -o /tmp/fuzz_frame_views
+    /tmp/fuzz_frame_views -max_len=128
+
+  Random inputs are mostly frames close to valid ones (right header, length, markers) with
+  a few bytes changed, truncated or extended, so the checks behind the first bytes are
+  reached too. Besides memory errors, a view is checked against the frame layout: a valid
+  view has a consistent length field and markers, and the accessors stay inside the buffer.
+*/
+#include "frame_views.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace esphome::LD2412;
+
+namespace {
+
+volatile uint32_t sink;
+
+void check(bool condition, const char *what, const uint8_t *data, size_t size) {
+  if (condition)
+    return;
+  std::fprintf(stderr, "Check failed: %s, input of %zu bytes:", what, size);
+  for (size_t i = 0; i < size; i++)
+    std::fprintf(stderr, " %02X", data[i]);
+  std::fprintf(stderr, "\n");
+  std::abort();
+}
+
+template<typename T> void cast(const uint8_t *buffer, size_t len) {
+  const T *frame = frame_cast<T>(buffer, len);
+  check((frame != nullptr) == (len >= sizeof(T) + FRAME_FOOTER_SIZE), "frame_cast length", buffer, len);
+  if (frame == nullptr)
+    return;
+  // reads the whole struct
+  uint32_t acc = 0;
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(frame);
+  for (size_t i = 0; i < sizeof(T); i++)
+    acc += bytes[i];
+  sink = acc;
+}
+
+void view(const uint8_t *buffer, size_t len) {
+  PeriodicFrameView frame(buffer, len);
+  if (!frame.is_valid()) {
+    check(!frame.is_engineering(), "invalid view in engineering mode", buffer, len);
+    return;
+  }
+  check(len >= NORMAL_FRAME_SIZE, "valid view shorter than a normal frame", buffer, len);
+  check(le16(reinterpret_cast<const FrameHeader *>(buffer)->length) + sizeof(FrameHeader) + FRAME_FOOTER_SIZE == len,
+        "valid view with a wrong length field", buffer, len);
+  check(buffer[offsetof(PeriodicFrame, head)] == 0xAA, "valid view without head marker", buffer, len);
+  check(buffer[len - sizeof(PeriodicFrameTail) - FRAME_FOOTER_SIZE] == 0x55, "valid view without end marker", buffer,
+        len);
+  uint32_t acc = frame.target_state() + frame.moving_distance() + frame.moving_energy() + frame.still_distance() +
+                 frame.still_energy() + frame.detection_distance() + frame.has_moving_target() +
+                 frame.has_still_target();
+  if (frame.is_engineering()) {
+    check(len >= ENGINEERING_FRAME_SIZE, "engineering view shorter than an engineering frame", buffer, len);
+    for (uint8_t gate = 0; gate < FRAME_GATES; gate++)
+      acc += frame.moving_energies()[gate] + frame.still_energies()[gate];
+    acc += frame.light() + frame.strongest_moving_gate() + frame.strongest_still_gate();
+    check(frame.strongest_moving_gate() < FRAME_GATES, "strongest moving gate out of range", buffer, len);
+    check(frame.strongest_still_gate() < FRAME_GATES, "strongest still gate out of range", buffer, len);
+    // the OUT pin byte follows the light byte, when the frame is longer than the base layout
+    check(frame.has_out_pin() == (len > ENGINEERING_FRAME_SIZE), "OUT pin byte presence", buffer, len);
+    if (frame.has_out_pin())
+      acc += frame.out_pin();
+  } else {
+    check(!frame.has_out_pin(), "OUT pin outside engineering mode", buffer, len);
+  }
+  sink = acc;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  // exact size copy, so that reads past the end are reported
+  std::vector<uint8_t> buffer(data, data + size);
+  const uint8_t *bytes = buffer.data();
+  view(bytes, size);
+  cast<FrameHeader>(bytes, size);
+  cast<PeriodicFrame>(bytes, size);
+  cast<EngineeringFrame>(bytes, size);
+  cast<AckFrame>(bytes, size);
+  cast<AckVersionFrame>(bytes, size);
+  cast<AckMacFrame>(bytes, size);
+  cast<AckDistanceResolutionFrame>(bytes, size);
+  cast<AckQueryFrame>(bytes, size);
+  cast<AckGateSensitivityFrame>(bytes, size);
+  cast<AckBackgroundCorrectionFrame>(bytes, size);
+  cast<AckLightControlFrame>(bytes, size);
+  return 0;
+}
+
+#ifndef LD2412_LIBFUZZER
+namespace {
+
+const uint8_t DATA_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+const uint8_t DATA_FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+
+// A valid periodic frame, engineering mode with optional OUT pin byte, or normal mode
+std::vector<uint8_t> periodic_frame(std::mt19937 &rng) {
+  bool engineering = rng() % 2;
+  size_t payload = (engineering ? sizeof(EngineeringFrame) : sizeof(PeriodicFrame)) - sizeof(FrameHeader);
+  // firmwares with the OUT pin byte, and possible later additions
+  if (engineering)
+    payload += rng() % 3;
+  payload += sizeof(PeriodicFrameTail);
+  std::vector<uint8_t> frame(DATA_HEADER, DATA_HEADER + 4);
+  frame.push_back(payload & 0xFF);
+  frame.push_back(payload >> 8);
+  frame.push_back(engineering ? 0x01 : 0x02);
+  frame.push_back(0xAA);
+  while (frame.size() < sizeof(FrameHeader) + payload - sizeof(PeriodicFrameTail))
+    frame.push_back(rng() % 101);
+  frame.push_back(0x55);
+  frame.push_back(0x00);
+  frame.insert(frame.end(), DATA_FOOTER, DATA_FOOTER + 4);
+  return frame;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+  std::mt19937 rng(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1);
+  uint64_t valid = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    std::vector<uint8_t> input;
+    switch (rng() % 4) {
+      case 0:
+        // random bytes
+        input.resize(rng() % 128);
+        for (auto &b : input)
+          b = rng();
+        break;
+      case 1:
+        // valid frame
+        input = periodic_frame(rng);
+        break;
+      default: {
+        // valid frame with changed bytes, truncated or extended
+        input = periodic_frame(rng);
+        for (uint32_t n = rng() % 4; n > 0; n--)
+          input[rng() % input.size()] = rng();
+        if (rng() % 2)
+          input.resize(rng() % (input.size() + 8), rng());
+      } break;
+    }
+    valid += PeriodicFrameView(input.data(), input.size()).is_valid();
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%llu inputs, %llu valid periodic frames, %.0f exec/s\n", (unsigned long long) iterations,
+              (unsigned long long) valid, iterations / seconds);
+  return 0;
+}
+#endif
@@ -0,0 +1,451 @@
+#!/usr/bin/env python3
+"""Software LD2412 for testing the component without the radar.
+
+The emulator answers the command/ACK protocol and streams periodic frames on a
+pseudo-terminal (default) or on a real serial port (needs pyserial), so an ESP
+wired to a USB-UART adapter can be exercised from a PC:
+
+    tools/ld2412_emulator.py                      # prints the pty to open
+    tools/ld2412_emulator.py --port /dev/ttyUSB0 --baud 256000 --engineering
+    tools/ld2412_emulator.py --interval 2 --fault-rate 0.05 --faults bad_header,truncated_ack
+
+On exit (Ctrl+C) it prints the frame throughput and, per command, the number of
+commands received and the delay between the command and its ACK.
+"""
+
+import argparse
+import heapq
+import math
+import os
+import random
+import select
+import struct
+import sys
+import time
+import tty
+
+DATA_HEADER = bytes([0xF4, 0xF3, 0xF2, 0xF1])
+DATA_FOOTER = bytes([0xF8, 0xF7, 0xF6, 0xF5])
+CMD_HEADER = bytes([0xFD, 0xFC, 0xFB, 0xFA])
+CMD_FOOTER = bytes([0x04, 0x03, 0x02, 0x01])
+
+GATES = 14
+
+CMD_SET_DISTANCE_RESOLUTION = 0x01
+CMD_BASIC_CONF = 0x02
+CMD_MOTION_GATE_SENS = 0x03
+CMD_STATIC_GATE_SENS = 0x04
+CMD_DYNAMIC_BACKGROUND_CORRECTION = 0x0B
+CMD_QUERY_DISTANCE_RESOLUTION = 0x11
+CMD_QUERY = 0x12
+CMD_QUERY_MOTION_GATE_SENS = 0x13
+CMD_QUERY_STATIC_GATE_SENS = 0x14
+CMD_QUERY_DYNAMIC_BACKGROUND_CORRECTION = 0x1B
+CMD_ENABLE_ENG = 0x62
+CMD_DISABLE_ENG = 0x63
+CMD_VERSION = 0xA0
+CMD_SET_BAUD_RATE = 0xA1
+CMD_RESET = 0xA2
+CMD_RESTART = 0xA3
+CMD_BLUETOOTH = 0xA4
+CMD_MAC = 0xA5
+CMD_BT_PASSWORD = 0xA9
+CMD_SET_LIGHT_CONTROL = 0xAD
+CMD_QUERY_LIGHT_CONTROL = 0xAE
+CMD_DISABLE_CONF = 0xFE
+CMD_ENABLE_CONF = 0xFF
+
+BAUD_RATES = {1: 9600, 2: 19200, 3: 38400, 4: 57600, 5: 115200, 6: 230400, 7: 256000, 8: 460800}
+
+# Commands that --unsupported can turn off, as on firmwares that answer them with an error
+OPTIONAL_COMMANDS = {
+    "light_control": (CMD_QUERY_LIGHT_CONTROL, CMD_SET_LIGHT_CONTROL),
+    "background_query": (CMD_QUERY_DYNAMIC_BACKGROUND_CORRECTION,),
+}
+
+FAULTS = ("bad_header", "bad_footer", "truncated_ack", "delayed_ack", "short_mac", "garbage")
+
+# Module behaviour timings, in seconds
+RESTART_TIME = 1.0
+
+
+def data_frame(payload):
+    return DATA_HEADER + struct.pack("<H", len(payload)) + payload + DATA_FOOTER
+
+
+def ack_frame(command, values=b"", status=0):
+    payload = struct.pack("<BBH", command, 0x01, status) + values
+    return CMD_HEADER + struct.pack("<H", len(payload)) + payload + CMD_FOOTER
+
+
+class Target:
+    """A person walking back and forth, stopping at both ends."""
+
+    def __init__(self, near, far, period):
+        self.near = near
+        self.far = far
+        self.period = period
+
+    def state(self, now):
+        phase = (now % self.period) / self.period
+        # walk for 70% of the period, stand still for the rest
+        if phase < 0.35:
+            return self.near + (self.far - self.near) * phase / 0.35, True
+        if phase < 0.5:
+            return self.far, False
+        if phase < 0.85:
+            return self.far - (self.far - self.near) * (phase - 0.5) / 0.35, True
+        return self.near, False
+
+
+class Emulator:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.target = Target(args.near, args.far, args.period)
+        self.faults = set(args.faults.split(",")) if args.faults else set()
+        self.unsupported = {cmd for name in args.unsupported.split(",") if name for cmd in OPTIONAL_COMMANDS[name]}
+        self.rx = bytearray()
+        self.queue = []  # (time, sequence, bytes, command, time the command was received, clean frame)
+        self.sequence = 0
+        self.start = time.monotonic()
+        self.next_frame = self.start
+        self.offline_until = 0.0
+        # module state
+        self.config_mode = False
+        self.engineering = args.engineering
+        self.reset_settings()
+        self.bluetooth = True
+        self.background_until = 0.0
+        self.baud_rate = args.baud
+        # statistics
+        self.frames = 0
+        self.frame_bytes = 0
+        self.commands = {}
+        self.latencies = {}
+        self.injected = {fault: 0 for fault in FAULTS}
+        self.overflows = 0
+        # (time.monotonic_ns() of the write, frame) of each periodic frame written when set to a
+        # list, frame is None when a fault corrupted it (tools/ld2412_emulator_suite.py)
+        self.written = None
+
+    def reset_settings(self):
+        """Factory defaults"""
+        self.resolution = 0x00
+        self.min_gate, self.max_gate, self.duration = 1, 12, 5
+        self.out_pin_level = 0x00
+        self.light_function, self.light_threshold = 0x00, 0x80
+        self.move_thresholds = [30] * GATES
+        self.still_thresholds = [25] * GATES
+
+    # ---- output scheduling ----
+
+    def send(self, data, delay=0.0, command=None, received=None, frame=None):
+        self.sequence += 1
+        heapq.heappush(self.queue, (time.monotonic() + delay, self.sequence, data, command, received, frame))
+
+    def flush(self, now):
+        while self.queue and self.queue[0][0] <= now:
+            _, _, data, command, received, frame = heapq.heappop(self.queue)
+            written = time.monotonic_ns()
+            try:
+                os.write(self.fd, data)
+            except BlockingIOError:
+                # nobody reads the port, bytes are lost like on a real UART
+                self.overflows += 1
+                continue
+            if command is not None:
+                self.latencies.setdefault(command, []).append(time.monotonic() - received)
+            elif self.written is not None:
+                self.written.append((written, frame))
+
+    def fault(self, name):
+        if name in self.faults and self.rng.random() < self.args.fault_rate:
+            self.injected[name] += 1
+            return True
+        return False
+
+    # ---- periodic frames ----
+
+    def gate_size(self):
+        return {0x00: 75, 0x01: 50, 0x03: 20}.get(self.resolution, 75)
+
+    def periodic_frame(self, now):
+        distance, moving = self.target.state(now - self.start)
+        gate_size = self.gate_size()
+        in_range = distance < GATES * gate_size
+        state = (0x01 if moving else 0x02) if in_range else 0x00
+        move_energy = min(100, int(60 + 30 * math.sin(now * 7))) if moving else 0
+        still_energy = min(100, int(45 + self.rng.random() * 10)) if in_range else 0
+        cm = int(distance)
+        payload = struct.pack(
+            "<BBBHBHB",
+            0x01 if self.engineering else 0x02,
+            0xAA,
+            state,
+            cm if moving else 0,
+            move_energy,
+            cm,
+            still_energy,
+        )
+        if self.engineering:
+            target_gate = distance / gate_size
+            moving_energies = bytearray()
+            still_energies = bytearray()
+            for gate in range(self.args.gates):
+                bump = math.exp(-((gate - target_gate) ** 2) / 2.0)
+                noise = self.rng.randint(0, 8)
+                moving_energies.append(min(100, int(bump * move_energy) + noise))
+                still_energies.append(min(100, int(bump * still_energy) + noise))
+            light = int(128 + 60 * math.sin(now / 30))
+            payload += bytes([self.max_gate, self.max_gate]) + moving_energies + still_energies + bytes([light])
+        payload += bytes([0x55, 0x00])
+        return data_frame(payload)
+
+    def emit_frame(self, now):
+        clean = self.periodic_frame(now)
+        frame = bytearray(clean)
+        if self.fault("bad_header"):
+            frame[self.rng.randrange(4)] ^= 0xFF
+            clean = None
+        if self.fault("bad_footer"):
+            frame[-1] ^= 0xFF
+            clean = None
+        if self.fault("garbage"):
+            # the frame behind the garbage is intact
+            frame = bytes(self.rng.randrange(256) for _ in range(self.rng.randint(1, 16))) + frame
+        self.send(bytes(frame), frame=clean)
+        self.frames += 1
+        self.frame_bytes += len(frame)
+
+    # ---- commands ----
+
+    def parse(self):
+        while True:
+            start = self.rx.find(CMD_HEADER)
+            if start < 0:
+                del self.rx[:-3]
+                return
+            del self.rx[:start]
+            if len(self.rx) < 6:
+                return
+            length = struct.unpack_from("<H", self.rx, 4)[0]
+            end = 6 + length + 4
+            if len(self.rx) < end:
+                return
+            frame = bytes(self.rx[:end])
+            del self.rx[:end]
+            if frame[-4:] != CMD_FOOTER or length < 2:
+                print(f"Dropped malformed command {frame.hex(' ')}", file=sys.stderr)
+                continue
+            command = struct.unpack_from("<H", frame, 6)[0]
+            self.handle(command, frame[8:-4])
+
+    def reply(self, command, values=b"", status=0, received=None):
+        frame = ack_frame(command & 0xFF, values, status)
+        delay = 0.0
+        if self.fault("truncated_ack"):
+            frame = frame[: self.rng.randint(4, len(frame) - 1)]
+        if self.fault("delayed_ack"):
+            delay = self.args.ack_delay / 1000
+        self.send(frame, delay, command, received)
+
+    def handle(self, command, value):
+        received = time.monotonic()
+        self.commands[command] = self.commands.get(command, 0) + 1
+        if self.args.verbose:
+            print(f"<- {command:02X} {value.hex(' ')}", file=sys.stderr)
+        if received < self.offline_until:
+            return
+        if command == CMD_ENABLE_CONF:
+            self.config_mode = True
+            # protocol version, buffer size
+            self.reply(command, struct.pack("<HH", 0x0001, 0x0040), received=received)
+            return
+        if not self.config_mode or command in self.unsupported:
+            self.reply(command, status=1, received=received)
+            return
+        values = b""
+        if command == CMD_DISABLE_CONF:
+            self.config_mode = False
+        elif command == CMD_VERSION:
+            values = struct.pack("<HHI", 0x2412, 0x0101, 0x24061215)
+        elif command == CMD_MAC:
+            mac = bytes([0x8F, 0x27, 0x2E, 0xB8, 0x0F, 0x65]) if self.bluetooth else bytes([0x08, 0x05, 0x04, 0x03, 0x02, 0x01])
+            values = mac[:3] if self.fault("short_mac") else mac
+        elif command == CMD_QUERY_DISTANCE_RESOLUTION:
+            values = bytes([self.resolution, 0x00, 0x00, 0x00, 0x00, 0x00])
+        elif command == CMD_SET_DISTANCE_RESOLUTION:
+            if value:
+                self.resolution = value[0]
+        elif command == CMD_QUERY:
+            values = struct.pack("<BBHB", self.min_gate, self.max_gate, self.duration, self.out_pin_level)
+        elif command == CMD_BASIC_CONF:
+            if len(value) >= 5:
+                self.min_gate, self.max_gate, self.duration, self.out_pin_level = struct.unpack_from("<BBHB", value)
+        elif command == CMD_QUERY_MOTION_GATE_SENS:
+            values = bytes(self.move_thresholds)
+        elif command == CMD_QUERY_STATIC_GATE_SENS:
+            values = bytes(self.still_thresholds)
+        elif command == CMD_MOTION_GATE_SENS:
+            self.move_thresholds = list(value[:GATES])
+        elif command == CMD_STATIC_GATE_SENS:
+            self.still_thresholds = list(value[:GATES])
+        elif command == CMD_ENABLE_ENG:
+            self.engineering = True
+        elif command == CMD_DISABLE_ENG:
+            self.engineering = False
+        elif command == CMD_DYNAMIC_BACKGROUND_CORRECTION:
+            self.background_until = received + self.args.background_time / 1000
+        elif command == CMD_QUERY_DYNAMIC_BACKGROUND_CORRECTION:
+            values = bytes([0x01 if received < self.background_until else 0x00, 0x00])
+        elif command == CMD_QUERY_LIGHT_CONTROL:
+            values = bytes([self.light_function, self.light_threshold, self.out_pin_level, 0x00])
+        elif command == CMD_SET_LIGHT_CONTROL:
+            if len(value) >= 3:
+                self.light_function, self.light_threshold, self.out_pin_level = value[:3]
+        elif command == CMD_BLUETOOTH:
+            self.bluetooth = bool(value and value[0])
+        elif command == CMD_SET_BAUD_RATE:
+            rate = BAUD_RATES.get(value[0] if value else 0)
+            if rate is None:
+                self.reply(command, status=1, received=received)
+                return
+            print(f"Baud rate set to {rate}, effective after restart", file=sys.stderr)
+            self.baud_rate = rate
+        elif command in (CMD_RESTART, CMD_RESET):
+            if command == CMD_RESET:
+                self.reset_settings()
+            self.reply(command, received=received)
+            self.config_mode = False
+            self.offline_until = received + RESTART_TIME
+            self.next_frame = self.offline_until
+            return
+        elif command == CMD_BT_PASSWORD:
+            pass
+        else:
+            self.reply(command, status=1, received=received)
+            return
+        self.reply(command, values, received=received)
+
+
+    # ---- main loop ----
+
+    def run(self, duration=None):
+        interval = self.args.interval / 1000
+        end = None if duration is None else time.monotonic() + duration
+        while True:
+            now = time.monotonic()
+            if end is not None and now >= end:
+                return
+            if not self.config_mode and now >= self.offline_until and now >= self.next_frame:
+                self.emit_frame(now)
+                # do not try to catch up after a stall, keep the rate
+                self.next_frame = max(self.next_frame + interval, now)
+            self.flush(now)
+            deadline = self.next_frame
+            if self.queue:
+                deadline = min(deadline, self.queue[0][0])
+            if end is not None:
+                deadline = min(deadline, end)
+            timeout = max(0.0, deadline - time.monotonic())
+            readable, _, _ = select.select([self.fd], [], [], timeout)
+            if readable:
+                try:
+                    data = os.read(self.fd, 4096)
+                except OSError:
+                    # the other side of the pty is not open (yet)
+                    time.sleep(0.05)
+                    continue
+                self.rx.extend(data)
+                self.parse()
+
+    def report(self):
+        elapsed = time.monotonic() - self.start
+        print(f"\n{self.frames} frames in {elapsed:.1f}s: {self.frames / elapsed:.1f} frames/s, "
+              f"{self.frame_bytes / elapsed:.0f} bytes/s", file=sys.stderr)
+        wire = self.frame_bytes * 10 / elapsed
+        print(f"UART load at {self.baud_rate} baud: {100 * wire / self.baud_rate:.1f}%", file=sys.stderr)
+        for command in sorted(self.commands):
+            latencies = sorted(self.latencies.get(command, []))
+            line = f"  command {command:02X}: {self.commands[command]} received"
+            if latencies:
+                mean = sum(latencies) / len(latencies)
+                line += f", ACK delay mean {mean * 1000:.2f}ms max {latencies[-1] * 1000:.2f}ms"
+            print(line, file=sys.stderr)
+        if self.overflows:
+            print(f"  {self.overflows} writes lost, the port was not read fast enough", file=sys.stderr)
+        injected = {fault: count for fault, count in self.injected.items() if count}
+        if injected:
+            print(f"  injected faults: {injected}", file=sys.stderr)
+
+
+def open_port(args):
+    if args.port:
+        try:
+            import serial  # pylint: disable=import-outside-toplevel
+        except ImportError:
+            sys.exit("--port needs pyserial (pip install pyserial)")
+        port = serial.Serial(args.port, args.baud, timeout=0, write_timeout=0)
+        return port.fileno(), port
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(master, False)
+    print(f"LD2412 emulator on {os.ttyname(slave)}", file=sys.stderr)
+    return master, slave
+
+
+def build_parser():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port to use instead of a pseudo-terminal")
+    parser.add_argument("--baud", type=int, default=256000, help="baud rate of --port, and for the UART load report")
+    parser.add_argument("--interval", type=float, default=50, help="time between periodic frames in ms")
+    parser.add_argument("--engineering", action="store_true", help="start in engineering mode")
+    parser.add_argument("--gates", type=int, default=GATES, help="gates in engineering frames, as on other firmwares")
+    parser.add_argument(
+        "--unsupported", default="", help=f"comma separated commands to reject among {', '.join(OPTIONAL_COMMANDS)}"
+    )
+    parser.add_argument("--near", type=float, default=80, help="closest distance of the simulated person in cm")
+    parser.add_argument("--far", type=float, default=600, help="farthest distance of the simulated person in cm")
+    parser.add_argument("--period", type=float, default=20, help="duration of one walk back and forth in s")
+    parser.add_argument("--faults", default="", help=f"comma separated faults to inject among {', '.join(FAULTS)}")
+    parser.add_argument("--fault-rate", type=float, default=0.02, help="probability of each enabled fault")
+    parser.add_argument("--ack-delay", type=float, default=500, help="delay of delayed ACKs in ms")
+    parser.add_argument(
+        "--background-time", type=float, default=10000, help="duration of a background correction in ms"
+    )
+    parser.add_argument("--seed", type=int, help="random seed, for reproducible runs")
+    parser.add_argument("--verbose", action="store_true", help="log received commands")
+    return parser
+
+
+def check_args(parser, args):
+    unknown = set(filter(None, args.faults.split(","))) - set(FAULTS)
+    if unknown:
+        parser.error(f"unknown faults: {', '.join(sorted(unknown))}")
+    unknown = set(filter(None, args.unsupported.split(","))) - set(OPTIONAL_COMMANDS)
+    if unknown:
+        parser.error(f"unknown commands: {', '.join(sorted(unknown))}")
+    if not 1 <= args.gates <= 32:
+        parser.error("--gates must be between 1 and 32")
+
+
+def main():
+    parser = build_parser()
+    args = parser.parse_args()
+    check_args(parser, args)
+
+    # the slave end (or the serial object) stays open for the whole run
+    fd, _handle = open_port(args)
+    emulator = Emulator(fd, args)
+    try:
+        emulator.run()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        emulator.report()
+
+
+if __name__ == "__main__":
+    main()
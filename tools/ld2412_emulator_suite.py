@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+"""Throughput and latency checks of the frame decoding against the emulator.
+
+Each scenario runs tools/ld2412_emulator.py on a pseudo-terminal, with its fault
+injection, and tools/ld2412_host_decoder.cpp (the component's frame parser and views)
+on the other end. Every periodic frame the emulator writes is matched with the frames
+the decoder returns, and the scenario fails when:
+- a frame corrupted by a fault is decoded, or an intact frame is lost
+- fewer frames/s than expected are decoded
+- the decode latency (from the write to the decoded frame) is above its bound
+- config mode sessions (enable config, version, disable config) complete too rarely or
+  their ACKs are too slow
+- the ACKs of other sessions are handled wrong: a MAC cut by the short_mac fault is not
+  reported as truncated, or background correction polling does not see the correction end
+
+    python3 tools/ld2412_emulator_suite.py                 # all scenarios
+    python3 tools/ld2412_emulator_suite.py high_rate acks  # some of them
+
+The decoder is built with g++ (or $CXX) in a temporary directory. Latencies are those
+of the PC and the pty, not of an ESP, they catch a parser that stalls or falls behind.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import ld2412_emulator  # noqa: E402  pylint: disable=wrong-import-position
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DECODER = os.path.join(ROOT, "tools", "ld2412_host_decoder.cpp")
+
+# Time the decoder is given to open the port, and to read the last frames
+START_TIME = 0.3
+DRAIN_TIME = 0.5
+
+
+class Scenario:
+    def __init__(self, name, emulator_args, duration=5.0, min_fps=None, max_p99_ms=5.0, max_lost=0,
+                 query_interval=0, min_sessions=0.0, max_ack_p99_ms=None, commands=None, first_commands=None,
+                 check=None):
+        self.name = name
+        self.emulator_args = emulator_args
+        self.duration = duration
+        # decoded frames/s, 95% of the intact frames written by default
+        self.min_fps = min_fps
+        self.max_p99_ms = max_p99_ms
+        # intact frames that may be lost, behind a cut ACK
+        self.max_lost = max_lost
+        self.query_interval = query_interval
+        # share of the config mode sessions that must complete
+        self.min_sessions = min_sessions
+        self.max_ack_p99_ms = max_ack_p99_ms
+        # commands of the sessions in hex, enable config, version, disable config by default
+        self.commands = commands
+        self.first_commands = first_commands
+        # check(acks, truncated, emulator) returns the errors of the ACK handling
+        self.check = check
+
+
+def check_mac(acks, truncated, emulator):
+    """Every MAC cut by short_mac is too short for AckMacFrame, the others are whole."""
+    errors = []
+    short = emulator.injected["short_mac"]
+    cut = sum(1 for command, _ in truncated if command == 0xA5)
+    if short == 0:
+        errors.append("no MAC ACK was cut, the scenario tests nothing")
+    if cut != short:
+        errors.append(f"{cut} MAC ACKs reported truncated, {short} cut by the emulator")
+    macs = {values for command, _, _, values in acks if command == 0xA5}
+    if macs - {"8f272eb80f65"}:
+        errors.append(f"wrong MACs decoded: {', '.join(sorted(macs))}")
+    if not macs:
+        errors.append("no whole MAC ACK")
+    return errors
+
+
+def check_background_correction(acks, truncated, emulator):
+    """The polls see the correction started by the first session running, then done."""
+    errors = []
+    if truncated:
+        errors.append(f"{len(truncated)} truncated ACKs")
+    if not any(command == 0x0B for command, _, _, _ in acks):
+        errors.append("background correction not started")
+    active = [int(values[:2], 16) for command, _, _, values in acks if command == 0x1B]
+    if not active or active[0] != 1 or active[-1] != 0:
+        errors.append(f"polls did not see the correction run then end: {active}")
+    elif sorted(active, reverse=True) != active:
+        errors.append(f"correction reported active again after its end: {active}")
+    return errors
+
+
+SCENARIOS = [
+    Scenario("normal", ["--interval", "50"]),
+    Scenario("engineering", ["--interval", "20", "--engineering"]),
+    # a frame every 2ms is beyond 256000 baud for engineering frames, the parser must keep up anyway
+    Scenario("high_rate", ["--interval", "2", "--engineering"], min_fps=400, max_p99_ms=10.0),
+    Scenario("frame_faults", ["--interval", "10", "--engineering", "--faults", "bad_header,bad_footer,garbage",
+                              "--fault-rate", "0.1"]),
+    Scenario("acks", ["--interval", "20", "--engineering"], min_fps=25, query_interval=250, min_sessions=0.95,
+             max_ack_p99_ms=5.0),
+    # each of the three ACKs of a session is cut or delayed by 500ms one time in twenty. A cut ACK
+    # swallows the start of what follows until its length is read, and the module stays in config
+    # mode, without frames, until a later session disables it
+    Scenario("ack_faults", ["--interval", "20", "--engineering", "--faults", "truncated_ack,delayed_ack",
+                            "--fault-rate", "0.05"], duration=10.0, min_fps=10, max_lost=10, query_interval=250,
+             min_sessions=0.4, max_ack_p99_ms=600.0),
+    # one MAC ACK in five only carries half of the MAC, as seen on some firmwares
+    Scenario("mac", ["--interval", "20", "--engineering", "--faults", "short_mac", "--fault-rate", "0.2"],
+             min_fps=25, query_interval=250, min_sessions=0.95, max_ack_p99_ms=5.0, commands="ff,a5,fe",
+             check=check_mac),
+    # start a 2s correction, then poll it as the component does until it reports the end
+    Scenario("background_correction", ["--interval", "20", "--engineering", "--background-time", "2000"],
+             min_fps=25, query_interval=250, min_sessions=0.95, max_ack_p99_ms=5.0, commands="ff,1b,fe",
+             first_commands="ff,0b,fe", check=check_background_correction),
+]
+
+
+def build_decoder(directory):
+    binary = os.path.join(directory, "ld2412_host_decoder")
+    compiler = os.environ.get("CXX", "g++")
+    subprocess.run([compiler, "-O2", "-std=gnu++17", "-I", os.path.join(ROOT, "components", "LD2412"), DECODER,
+                    "-o", binary], check=True)
+    return binary
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p))]
+
+
+def run(scenario, decoder, seed):
+    parser = ld2412_emulator.build_parser()
+    args = parser.parse_args(scenario.emulator_args + ["--seed", str(seed)])
+    ld2412_emulator.check_args(parser, args)
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(master, False)
+    command = [decoder, os.ttyname(slave), str(START_TIME + scenario.duration + DRAIN_TIME)]
+    if scenario.query_interval:
+        command.append(str(scenario.query_interval))
+        if scenario.commands:
+            command.append(scenario.commands)
+        if scenario.first_commands:
+            command.append(scenario.first_commands)
+    process = subprocess.Popen(command, stdout=subprocess.PIPE, text=True)
+    try:
+        time.sleep(START_TIME)
+        emulator = ld2412_emulator.Emulator(master, args)
+        emulator.written = []
+        thread = threading.Thread(target=emulator.run, args=(scenario.duration,))
+        thread.start()
+        output, _ = process.communicate(timeout=scenario.duration + 10)
+        thread.join()
+    finally:
+        if process.poll() is None:
+            process.kill()
+        os.close(master)
+        os.close(slave)
+
+    decoded = []
+    acks = []
+    truncated = []
+    summary = None
+    rejected = 0
+    for line in output.splitlines():
+        fields = line.split()
+        if fields[0] == "F":
+            decoded.append((int(fields[1]), bytes.fromhex(fields[2])))
+        elif fields[0] == "X":
+            rejected += 1
+        elif fields[0] == "A":
+            acks.append((int(fields[2], 16), int(fields[3]), int(fields[4]), fields[5]))
+        elif fields[0] == "T":
+            truncated.append((int(fields[2], 16), int(fields[3])))
+        elif fields[0] == "S":
+            summary = [int(field) for field in fields[1:]]
+    if summary is None or process.returncode != 0:
+        return [f"decoder exited with {process.returncode}"], ""
+
+    # match in order, the frames written but not decoded are lost
+    errors = []
+    latencies = []
+    lost = 0
+    written = iter(emulator.written)
+    for received, frame in decoded:
+        for write_time, expected in written:
+            if expected == frame:
+                latencies.append((received - write_time) / 1e6)
+                break
+            if expected is not None:
+                lost += 1
+        else:
+            errors.append(f"decoded a frame that was not written intact: {frame.hex()}")
+            break
+    lost += sum(1 for _, expected in written if expected is not None)
+    corrupted = sum(1 for _, expected in emulator.written if expected is None)
+
+    fps = len(latencies) / scenario.duration
+    min_fps = scenario.min_fps
+    if min_fps is None:
+        min_fps = 0.95 * (len(emulator.written) - corrupted) / scenario.duration
+    p50, p99 = percentile(latencies, 0.5), percentile(latencies, 0.99)
+    if rejected:
+        errors.append(f"{rejected} frames rejected by the view")
+    if lost > scenario.max_lost:
+        errors.append(f"{lost} intact frames lost (at most {scenario.max_lost})")
+    if emulator.overflows:
+        errors.append(f"{emulator.overflows} writes lost by the emulator, the decoder did not read")
+    if fps < min_fps:
+        errors.append(f"{fps:.1f} frames/s decoded (at least {min_fps:.1f})")
+    if p99 > scenario.max_p99_ms:
+        errors.append(f"p99 decode latency {p99:.2f}ms (at most {scenario.max_p99_ms:.2f}ms)")
+    report = (f"{len(latencies)} frames, {fps:.1f} frames/s, latency p50 {p50:.2f}ms p99 {p99:.2f}ms, "
+              f"{corrupted} corrupted {lost} lost")
+    if scenario.query_interval:
+        sessions, completed = summary[4], summary[5]
+        ack_ms = [rtt / 1e6 for _, _, rtt, _ in acks]
+        ack_p99 = percentile(ack_ms, 0.99)
+        if sessions == 0 or completed < scenario.min_sessions * sessions:
+            errors.append(f"{completed} of {sessions} sessions completed (at least {scenario.min_sessions:.0%})")
+        if ack_p99 > scenario.max_ack_p99_ms:
+            errors.append(f"p99 ACK delay {ack_p99:.2f}ms (at most {scenario.max_ack_p99_ms:.2f}ms)")
+        if any(result != 0 for _, result, _, _ in acks):
+            errors.append("ACK with an error status")
+        if scenario.check:
+            errors += scenario.check(acks, truncated, emulator)
+        report += f", {completed}/{sessions} sessions, ACK p50 {percentile(ack_ms, 0.5):.2f}ms p99 {ack_p99:.2f}ms"
+        if truncated:
+            report += f", {len(truncated)} truncated ACKs"
+    injected = {fault: count for fault, count in emulator.injected.items() if count}
+    if injected:
+        report += f", injected {injected}"
+    return errors, report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("scenarios", nargs="*", help=f"scenarios to run among {', '.join(s.name for s in SCENARIOS)}")
+    parser.add_argument("--seed", type=int, default=1, help="random seed of the emulator")
+    args = parser.parse_args()
+    names = {scenario.name for scenario in SCENARIOS}
+    unknown = set(args.scenarios) - names
+    if unknown:
+        parser.error(f"unknown scenarios: {', '.join(sorted(unknown))}")
+
+    failed = False
+    with tempfile.TemporaryDirectory() as directory:
+        decoder = build_decoder(directory)
+        for scenario in SCENARIOS:
+            if args.scenarios and scenario.name not in args.scenarios:
+                continue
+            errors, report = run(scenario, decoder, args.seed)
+            print(f"{scenario.name:<21} {'FAIL' if errors else 'ok':<4} {report}")
+            for error in errors:
+                print(f"    {error}")
+            failed |= bool(errors)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Decoder for the gate_energies text sensor of the LD2412 component.
+
+The text sensor carries every gate energy of an engineering frame as one base64 string:
+gate count, moving energy of each gate, still energy of each gate, light (0-255).
+
+    tools/ld2412_gate_energies.py decode DgAAAAA...     # prints the gates
+    tools/ld2412_gate_energies.py benchmark --frames 1000
+
+`benchmark` compares, per frame, the native API messages and bytes sent to Home Assistant
+by the 28 gate sensors and the light sensor with those sent by the single text sensor.
+
+In a Home Assistant template (2024.6 or later) the bytes are read with
+`(states('text_sensor.gate_energies') | base64_decode(None))[1 + gate]`.
+"""
+
+import argparse
+import base64
+import random
+import struct
+import sys
+
+
+def decode(payload):
+    """Returns (moving energies, still energies, light), or raises ValueError."""
+    raw = base64.b64decode(payload, validate=True)
+    if not raw:
+        raise ValueError("empty payload")
+    gates = raw[0]
+    if len(raw) != 2 * gates + 2:
+        raise ValueError(f"{len(raw)} bytes for {gates} gates")
+    return list(raw[1 : 1 + gates]), list(raw[1 + gates : 1 + 2 * gates]), raw[-1]
+
+
+def encode(moving, still, light):
+    return base64.b64encode(bytes([len(moving)] + moving + still + [light])).decode()
+
+
+# ---- native API sizes (plaintext frames) ----
+
+
+def varint_size(value):
+    size = 1
+    while value >= 0x80:
+        value >>= 7
+        size += 1
+    return size
+
+
+def frame_size(message_type, payload_size):
+    # preamble 0x00, payload size and message type as varints
+    return 1 + varint_size(payload_size) + varint_size(message_type) + payload_size
+
+
+SENSOR_STATE_RESPONSE = 25
+TEXT_SENSOR_STATE_RESPONSE = 27
+
+
+def sensor_state_size(value):
+    # key (fixed32) and state (float), missing_state left out when false
+    payload = 1 + 4 + 1 + len(struct.pack("<f", value))
+    return frame_size(SENSOR_STATE_RESPONSE, payload)
+
+
+def text_sensor_state_size(text):
+    state = len(text.encode())
+    payload = 1 + 4 + 1 + varint_size(state) + state
+    return frame_size(TEXT_SENSOR_STATE_RESPONSE, payload)
+
+
+def benchmark(frames, gates, seed):
+    rng = random.Random(seed)
+    separate_messages = separate_bytes = vector_messages = vector_bytes = 0
+    last_light = None
+    for _ in range(frames):
+        moving = [rng.randint(0, 100) for _ in range(gates)]
+        still = [rng.randint(0, 100) for _ in range(gates)]
+        light = rng.randint(0, 255)
+        # gate sensors publish on every frame, light only when it changes
+        for energy in moving + still:
+            separate_messages += 1
+            separate_bytes += sensor_state_size(energy)
+        if light != last_light:
+            separate_messages += 1
+            separate_bytes += sensor_state_size(light * 100 // 255)
+            last_light = light
+        payload = encode(moving, still, light)
+        assert decode(payload) == (moving, still, light)
+        vector_messages += 1
+        vector_bytes += text_sensor_state_size(payload)
+    print(f"{frames} engineering frames, {gates} gates")
+    print(f"  gate and light sensors: {separate_messages / frames:.1f} messages, {separate_bytes / frames:.0f} bytes per frame")
+    print(f"  gate_energies         : {vector_messages / frames:.1f} messages, {vector_bytes / frames:.0f} bytes per frame")
+    print(
+        f"  reduction             : {separate_messages / vector_messages:.0f}x messages, "
+        f"{separate_bytes / vector_bytes:.1f}x bytes"
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    decode_parser = commands.add_parser("decode", help="print the gates of a payload")
+    decode_parser.add_argument("payload")
+    benchmark_parser = commands.add_parser("benchmark", help="compare the API traffic of both publications")
+    benchmark_parser.add_argument("--frames", type=int, default=1000)
+    benchmark_parser.add_argument("--gates", type=int, default=14)
+    benchmark_parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.command == "benchmark":
+        benchmark(args.frames, args.gates, args.seed)
+        return
+    try:
+        moving, still, light = decode(args.payload)
+    except ValueError as error:
+        sys.exit(f"Invalid payload: {error}")
+    print("gate  moving  still")
+    for gate, (move, rest) in enumerate(zip(moving, still)):
+        print(f"g{gate:<4} {move:6} {rest:6}")
+    print(f"light {light}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,231 @@
+/*
+  Host side of tools/ld2412_emulator_suite.py: reads a serial port or pty with the frame
+  parser and views of the component (frame_parser.h, frame_views.h) and reports every
+  decoded frame with the time it was read, so the suite can measure throughput and latency
+  against the emulator write times.
+
+    g++ -O2 -std=gnu++17 -I components/LD2412 tools/ld2412_host_decoder.cpp -o /tmp/ld2412_host_decoder
+    /tmp/ld2412_host_decoder /dev/pts/3 5 [query_interval_ms [commands [first_commands]]]
+
+  With a query interval, a config mode session is started every interval from the first
+  decoded frame, each command written once the previous ACK is decoded, as the component's
+  background correction polling does. A session without ACK for 1s is dropped. Its commands
+  are given in hex (ff,a0,fe by default: enable config, version, disable config), the first
+  session may run other commands, e.g. ff,0b,fe to start a background correction then poll
+  it with ff,1b,fe.
+
+  ACKs shorter than the view the component reads them with (AckVersionFrame, AckMacFrame,
+  AckBackgroundCorrectionFrame) are reported as truncated, and the session goes on as the
+  component does.
+
+  Output, one line per event, times in ns of CLOCK_MONOTONIC (time.monotonic_ns in Python):
+    F <time> <hex>              periodic frame with a valid view
+    X <time> <hex>              periodic frame rejected by the view
+    A <time> <command> <result> <round trip> <values>  result 65535 when the status is not 0x01,
+                                                       values in hex after the result, - if none
+    T <time> <command> <length> ACK shorter than its view
+    S <frames> <invalid> <bad length> <bad footer> <sessions> <completed>
+*/
+#include "frame_parser.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace esphome::LD2412;
+
+namespace {
+
+const uint64_t SESSION_TIMEOUT_NS = 1000000000ULL;
+const int MAX_SESSION_COMMANDS = 8;
+
+struct Commands {
+  uint8_t command[MAX_SESSION_COMMANDS];
+  int size{0};
+};
+
+// "ff,a0,fe"
+Commands parse_commands(const char *text) {
+  Commands commands;
+  while (*text != '\0' && commands.size < MAX_SESSION_COMMANDS) {
+    char *end;
+    unsigned long command = std::strtoul(text, &end, 16);
+    if (end == text)
+      break;
+    commands.command[commands.size++] = uint8_t(command);
+    text = *end == ',' ? end + 1 : end;
+  }
+  return commands;
+}
+
+// Whole ACK frame read by the component for command, footer included
+size_t ack_view_size(uint8_t command) {
+  switch (command) {
+    case 0xA0:
+      return sizeof(AckVersionFrame) + FRAME_FOOTER_SIZE;
+    case 0xA5:
+      return sizeof(AckMacFrame) + FRAME_FOOTER_SIZE;
+    case 0x1B:
+      return sizeof(AckBackgroundCorrectionFrame) + FRAME_FOOTER_SIZE;
+    default:
+      return sizeof(AckFrame) + FRAME_FOOTER_SIZE;
+  }
+}
+
+uint64_t now_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void print_frame(char type, uint64_t time, const uint8_t *buffer, int len) {
+  std::printf("%c %llu ", type, (unsigned long long) time);
+  for (int i = 0; i < len; i++)
+    std::printf("%02x", buffer[i]);
+  std::printf("\n");
+}
+
+struct Session {
+  const Commands *commands{nullptr};
+  // index in commands of the command waiting for its ACK, -1 when idle
+  int step{-1};
+  uint64_t sent{0};
+  uint64_t started{0};
+  uint32_t count{0};
+  uint32_t completed{0};
+};
+
+void write_command(int fd, uint8_t command, Session &session) {
+  uint8_t frame[16];
+  memcpy(frame, CMD_FRAME_HEADER, 4);
+  size_t len = 4;
+  bool value = command == 0xFF;
+  frame[len++] = value ? 4 : 2;
+  frame[len++] = 0;
+  frame[len++] = command;
+  frame[len++] = 0;
+  if (value) {
+    frame[len++] = 0x01;
+    frame[len++] = 0x00;
+  }
+  memcpy(frame + len, CMD_FRAME_END, 4);
+  len += 4;
+  if (write(fd, frame, len) != ssize_t(len))
+    std::perror("write");
+  session.sent = now_ns();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s <tty> <seconds> [query_interval_ms [commands [first_commands]]]\n", argv[0]);
+    return 2;
+  }
+  int fd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    std::perror(argv[1]);
+    return 1;
+  }
+  termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  uint64_t end = now_ns() + uint64_t(std::atof(argv[2]) * 1e9);
+  uint64_t query_interval = argc > 3 ? uint64_t(std::atof(argv[3]) * 1e6) : 0;
+  const Commands session_commands = parse_commands(argc > 4 ? argv[4] : "ff,a0,fe");
+  const Commands first_commands = argc > 5 ? parse_commands(argv[5]) : session_commands;
+  if (session_commands.size == 0 || first_commands.size == 0) {
+    std::fprintf(stderr, "no session commands\n");
+    return 2;
+  }
+  // set by the first frame, the module is not there before
+  uint64_t next_query = UINT64_MAX;
+
+  FrameParser parser;
+  uint8_t buffer[MAX_FRAME_LENGTH];
+  uint8_t input[4096];
+  Session session;
+  uint64_t frames = 0, invalid = 0, bad_length = 0, bad_footer = 0;
+  while (true) {
+    uint64_t now = now_ns();
+    if (now >= end)
+      break;
+    if (query_interval != 0) {
+      if (session.step >= 0 && now - session.sent > SESSION_TIMEOUT_NS)
+        session.step = -1;
+      if (session.step < 0 && now >= next_query) {
+        session.commands = session.count == 0 ? &first_commands : &session_commands;
+        session.step = 0;
+        session.count++;
+        session.started = now;
+        next_query = now + query_interval;
+        write_command(fd, session.commands->command[0], session);
+      }
+    }
+    pollfd pfd{fd, POLLIN, 0};
+    int timeout_ms = int((end - now) / 1000000) + 1;
+    if (query_interval != 0 && timeout_ms > 10)
+      timeout_ms = 10;
+    if (poll(&pfd, 1, timeout_ms) <= 0)
+      continue;
+    ssize_t n = read(fd, input, sizeof(input));
+    // the time the bytes were available, all of them are dated the same
+    uint64_t received = now_ns();
+    if (n <= 0)
+      continue;
+    for (ssize_t i = 0; i < n; i++) {
+      int len = parser.feed(input[i], buffer, MAX_FRAME_LENGTH);
+      if (len == FRAME_BAD_LENGTH)
+        bad_length++;
+      if (len == FRAME_BAD_FOOTER)
+        bad_footer++;
+      if (len <= 0)
+        continue;
+      if (buffer[0] == DATA_FRAME_HEADER[0]) {
+        PeriodicFrameView frame(buffer, len);
+        if (frame.is_valid()) {
+          frames++;
+          if (next_query == UINT64_MAX)
+            next_query = received;
+          print_frame('F', received, buffer, len);
+        } else {
+          invalid++;
+          print_frame('X', received, buffer, len);
+        }
+        continue;
+      }
+      const AckFrame *ack = frame_cast<AckFrame>(buffer, len);
+      if (ack == nullptr || session.step < 0 || ack->command != session.commands->command[session.step])
+        continue;
+      if (size_t(len) < ack_view_size(ack->command)) {
+        std::printf("T %llu %02x %d\n", (unsigned long long) received, ack->command, len);
+      } else {
+        unsigned result = ack->status == 0x01 ? le16(ack->result) : 0xFFFF;
+        std::printf("A %llu %02x %u %llu ", (unsigned long long) received, ack->command, result,
+                    (unsigned long long) (received - session.sent));
+        int values = len - int(sizeof(AckFrame) + FRAME_FOOTER_SIZE);
+        for (int i = 0; i < values; i++)
+          std::printf("%02x", buffer[sizeof(AckFrame) + i]);
+        std::printf("%s\n", values > 0 ? "" : "-");
+      }
+      session.step++;
+      if (session.step == session.commands->size) {
+        session.step = -1;
+        session.completed++;
+      } else {
+        write_command(fd, session.commands->command[session.step], session);
+      }
+    }
+  }
+  std::printf("S %llu %llu %llu %llu %u %u\n", (unsigned long long) frames, (unsigned long long) invalid,
+              (unsigned long long) bad_length, (unsigned long long) bad_footer, session.count, session.completed);
+  return 0;
+}
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Converts an LD2412 trace dump to the Chrome trace format.
+
+The `LD2412.dump_trace` action logs the trace ring, one `T <micros> <event> <arg> <value>`
+line per event. Save the log (`esphome logs device.yaml > trace.log`, or a copy of the
+web log), then:
+
+    tools/ld2412_trace.py trace.log -o trace.json
+
+and open trace.json in https://ui.perfetto.dev or chrome://tracing. The last dump of the
+log is converted, or the one chosen with --dump (0 is the first). Tracks:
+
+- commands: every command sent, the blocking wait after it, and its ACK with the latency
+- config mode: from CMD_ENABLE_CONF to CMD_DISABLE_CONF
+- frames: the decoding of each frame
+- frame wait: from the footer arrival to the start of decoding
+- publishes: one mark per entity publish, by priority
+"""
+
+import argparse
+import json
+import re
+import sys
+
+COMMANDS = {
+    0xFF: "enable config",
+    0xFE: "disable config",
+    0x62: "enable engineering",
+    0x63: "disable engineering",
+    0x60: "max distance and duration",
+    0x12: "query parameters",
+    0x02: "basic config",
+    0x64: "gate sensitivity",
+    0xA0: "version",
+    0x11: "query distance resolution",
+    0x01: "set distance resolution",
+    0xAE: "query light control",
+    0xAD: "set light control",
+    0xA1: "set baud rate",
+    0xA9: "bluetooth password",
+    0xA5: "mac",
+    0xA2: "factory reset",
+    0xA3: "restart",
+    0xA4: "bluetooth",
+    0x0B: "background correction",
+    0x1B: "query background correction",
+    0x03: "motion gate sensitivity",
+    0x13: "query motion gate sensitivity",
+    0x04: "still gate sensitivity",
+    0x14: "query still gate sensitivity",
+}
+CMD_ENABLE_CONF = 0xFF
+CMD_DISABLE_CONF = 0xFE
+
+PRIORITIES = ["presence", "distance", "diagnostic"]
+
+TRACKS = {"commands": 1, "config mode": 2, "frames": 3, "frame wait": 4, "publishes": 5}
+
+HEADER = re.compile(r"Trace: (\d+) events, (\d+) lost, now (\d+)")
+EVENT = re.compile(r"\bT (\d+) (\w+) (\d+) (\d+)")
+
+
+def read_dumps(lines):
+    """Returns the dumps of the log, each a list of (timestamp, event, arg, value)."""
+    dumps = []
+    for line in lines:
+        if HEADER.search(line):
+            dumps.append([])
+            continue
+        match = EVENT.search(line)
+        if match and dumps:
+            timestamp, event, arg, value = match.groups()
+            dumps[-1].append((int(timestamp), event, int(arg), int(value)))
+    return dumps
+
+
+def unwrap(events):
+    """micros() wraps every 71 minutes, timestamps are made monotonic in record order."""
+    result = []
+    offset = 0
+    previous = None
+    for timestamp, event, arg, value in events:
+        if previous is not None:
+            delta = (timestamp - previous) & 0xFFFFFFFF
+            # frame_received is dated back to the footer, a small negative step is not a wrap
+            if delta >= 1 << 31:
+                delta -= 1 << 32
+            offset += delta - (timestamp - previous)
+        previous = timestamp
+        result.append((timestamp + offset, event, arg, value))
+    return result
+
+
+def command_name(command):
+    return COMMANDS.get(command, f"command 0x{command:02X}")
+
+
+def convert(events):
+    trace = []
+    start = min((timestamp for timestamp, *_ in events), default=0)
+
+    def add(phase, track, name, timestamp, **fields):
+        entry = {"ph": phase, "pid": 1, "tid": TRACKS[track], "name": name, "ts": timestamp - start}
+        entry.update(fields)
+        trace.append(entry)
+
+    pending_acks = {}
+    config_since = None
+    received = None
+    wait_since = None
+    decode_since = None
+    for timestamp, event, arg, value in events:
+        if event == "command":
+            add("i", "commands", command_name(arg), timestamp, s="t", args={"value_length": value})
+            pending_acks[arg] = timestamp
+            if arg == CMD_ENABLE_CONF and config_since is None:
+                config_since = timestamp
+            elif arg == CMD_DISABLE_CONF and config_since is not None:
+                add("X", "config mode", "config mode", config_since, dur=timestamp - config_since)
+                config_since = None
+        elif event == "wait_begin":
+            wait_since = timestamp
+        elif event == "wait_end" and wait_since is not None:
+            add("X", "commands", f"wait after {command_name(arg)}", wait_since, dur=timestamp - wait_since)
+            wait_since = None
+        elif event == "ack":
+            command, result = arg & 0xFF, arg >> 8
+            ok = value == 0x01 and result == 0
+            args = {"status": value, "result": result, "ok": ok}
+            sent = pending_acks.pop(command, None)
+            if sent is not None:
+                args["latency_us"] = timestamp - sent
+            add("i", "commands", f"ACK {command_name(command)}" + ("" if ok else " (error)"), timestamp, s="t", args=args)
+        elif event == "frame_received":
+            received = timestamp
+        elif event == "frame_begin":
+            decode_since = timestamp
+            if received is not None:
+                add("X", "frame wait", "wait", received, dur=timestamp - received)
+                received = None
+        elif event == "frame_end" and decode_since is not None:
+            name = "engineering frame" if value == 0x01 else "frame"
+            add("X", "frames", name, decode_since, dur=timestamp - decode_since, args={"length": arg})
+            decode_since = None
+        elif event == "publish":
+            priority = PRIORITIES[arg] if arg < len(PRIORITIES) else str(arg)
+            kind = "binary sensor" if value else "sensor"
+            add("i", "publishes", f"{priority} {kind}", timestamp, s="t")
+    if config_since is not None:
+        add("B", "config mode", "config mode", config_since)
+    for track, tid in TRACKS.items():
+        trace.append({"ph": "M", "pid": 1, "tid": tid, "name": "thread_name", "args": {"name": track}})
+    trace.append({"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "LD2412"}})
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="log file holding a trace dump, - for stdin")
+    parser.add_argument("-o", "--output", default="-", help="Chrome trace JSON, stdout by default")
+    parser.add_argument("--dump", type=int, default=-1, help="dump to convert when the log holds several")
+    args = parser.parse_args()
+
+    log = sys.stdin if args.log == "-" else open(args.log, encoding="utf-8", errors="replace")
+    with log:
+        dumps = read_dumps(log)
+    if not dumps:
+        sys.exit("No trace dump in the log")
+    try:
+        events = unwrap(dumps[args.dump])
+    except IndexError:
+        sys.exit(f"The log holds {len(dumps)} dumps")
+    trace = convert(events)
+    output = sys.stdout if args.output == "-" else open(args.output, "w", encoding="utf-8")
+    with output:
+        json.dump(trace, output)
+    print(f"{len(events)} events, {len(trace['traceEvents'])} trace entries", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+/*
+  Host contention test of SPSCQueue (spsc_queue.h), with the producer and the consumer on
+  two std::threads, as the RX task and the loop on the two cores of an ESP32.
+
+    g++ -O2 -g -std=gnu++17 -pthread -I components/LD2412 tools/test_spsc_queue.cpp -o /tmp/test_spsc_queue
+    /tmp/test_spsc_queue [items]
+
+  Add -fsanitize=thread to have ThreadSanitizer check the memory ordering as well.
+
+  Items are frames of the size of RawFrame, numbered and filled with a pattern of their
+  number. Two runs:
+  - blocking: the producer waits for a free slot, the consumer must get every item, in order
+  - dropping: the producer drops items when the queue is full, as the RX task does, the
+    consumer must get increasing numbers and received + dropped must equal sent
+  Every item read is checked against its pattern, a torn slot (read while written) fails.
+*/
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <thread>
+
+using namespace esphome::LD2412;
+
+namespace {
+
+const size_t FRAME_BYTES = 80;
+
+struct Item {
+  uint64_t number;
+  uint8_t len;
+  uint8_t data[FRAME_BYTES];
+};
+
+// Same depth as the RX task queue (RX_QUEUE_SIZE)
+typedef SPSCQueue<Item, 16> Queue;
+
+void fill(Item &item, uint64_t number) {
+  item.number = number;
+  item.len = 21 + number % (FRAME_BYTES - 20);
+  for (uint8_t i = 0; i < item.len; i++)
+    item.data[i] = uint8_t(number * 31 + i);
+}
+
+bool intact(const Item &item) {
+  if (item.len != 21 + item.number % (FRAME_BYTES - 20))
+    return false;
+  for (uint8_t i = 0; i < item.len; i++) {
+    if (item.data[i] != uint8_t(item.number * 31 + i))
+      return false;
+  }
+  return true;
+}
+
+struct Result {
+  uint64_t received{0};
+  uint64_t dropped{0};
+  const char *error{nullptr};
+  uint64_t error_number{0};
+  double seconds{0};
+};
+
+Result run(uint64_t items, bool drop) {
+  static Queue queue;
+  std::atomic<bool> done{false};
+  Result result;
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    for (uint64_t number = 0; number < items; number++) {
+      if (drop) {
+        // paced, so that the queue is sometimes full and sometimes not
+        for (volatile uint32_t spin = 0; spin < 200; spin++) {
+        }
+      }
+      Item *slot = queue.producer_slot();
+      while (slot == nullptr && !drop) {
+        std::this_thread::yield();
+        slot = queue.producer_slot();
+      }
+      if (slot == nullptr) {
+        result.dropped++;
+        continue;
+      }
+      fill(*slot, number);
+      queue.push();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  std::thread consumer([&]() {
+    uint64_t expected = 0;
+    while (true) {
+      // read before front(), so that nothing pushed before done is missed
+      bool finished = done.load(std::memory_order_acquire);
+      Item *item = queue.front();
+      if (item == nullptr) {
+        if (finished)
+          return;
+        std::this_thread::yield();
+        continue;
+      }
+      if (!intact(*item)) {
+        result.error = "torn item";
+      } else if (drop ? item->number < expected : item->number != expected) {
+        result.error = drop ? "item out of order" : "item lost or out of order";
+      }
+      if (result.error != nullptr) {
+        result.error_number = item->number;
+        // let the producer finish
+        while (!done.load(std::memory_order_acquire)) {
+          if (queue.front() != nullptr)
+            queue.pop();
+        }
+        return;
+      }
+      expected = item->number + 1;
+      result.received++;
+      queue.pop();
+    }
+  });
+  producer.join();
+  consumer.join();
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint64_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  bool failed = false;
+  for (bool drop : {false, true}) {
+    Result result = run(items, drop);
+    const char *name = drop ? "dropping" : "blocking";
+    if (result.error != nullptr) {
+      std::printf("%s: %s at item %llu\n", name, result.error, (unsigned long long) result.error_number);
+      failed = true;
+      continue;
+    }
+    if (result.received + result.dropped != items) {
+      std::printf("%s: %llu received + %llu dropped of %llu sent\n", name, (unsigned long long) result.received,
+                  (unsigned long long) result.dropped, (unsigned long long) items);
+      failed = true;
+      continue;
+    }
+    std::printf("%s: %llu items, %llu received, %llu dropped, %.1f M items/s\n", name, (unsigned long long) items,
+                (unsigned long long) result.received, (unsigned long long) result.dropped,
+                items / result.seconds / 1e6);
+  }
+  return failed ? 1 : 0;
+}